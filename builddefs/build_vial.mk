@@ -8,6 +8,7 @@ ifeq ($(strip $(TAP_DANCE_ENABLE)), yes)
 endif
 COMBO_ENABLE ?= yes
 KEY_OVERRIDE_ENABLE ?= yes
+VIAL_DEF_STREAM_ENABLE ?= no
 SRC += $(QUANTUM_DIR)/vial.c
 OPT_DEFS += -DVIAL_ENABLE -DNO_DEBUG -DSERIAL_NUMBER=\"vial:f64c2b3c\"
 
@@ -15,6 +16,10 @@ ifeq ($(strip $(VIAL_INSECURE)), yes)
     OPT_DEFS += -DVIAL_INSECURE
 endif
 
+ifeq ($(strip $(VIAL_DEF_STREAM_ENABLE)), yes)
+    OPT_DEFS += -DVIAL_DEF_STREAM_ENABLE
+endif
+
 ifeq ($(strip $(VIALRGB_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/vialrgb.c
     OPT_DEFS += -DVIALRGB_ENABLE
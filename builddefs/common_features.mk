@@ -37,6 +37,11 @@ else
     include $(PLATFORM_PATH)/$(PLATFORM_KEY)/printf.mk
 endif
 
+# key to report latency in the profiling histograms comes from the tracer
+ifeq ($(strip $(PROFILING_ENABLE)), yes)
+    LATENCY_TRACE_ENABLE = yes
+endif
+
 ifeq ($(strip $(DEBUG_MATRIX_SCAN_RATE_ENABLE)), yes)
     OPT_DEFS += -DDEBUG_MATRIX_SCAN_RATE
     CONSOLE_ENABLE = yes
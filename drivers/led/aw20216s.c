@@ -48,6 +48,11 @@
 uint8_t g_pwm_buffer[AW20216S_DRIVER_COUNT][AW20216S_PWM_REGISTER_COUNT];
 bool    g_pwm_buffer_update_required[AW20216S_DRIVER_COUNT] = {false};
 
+// Lowest and highest PWM register changed since the last flush, so a flush
+// only sends that range instead of the whole page.
+static uint8_t g_pwm_buffer_dirty_first[AW20216S_DRIVER_COUNT] = {[0 ... AW20216S_DRIVER_COUNT - 1] = AW20216S_PWM_REGISTER_COUNT - 1};
+static uint8_t g_pwm_buffer_dirty_last[AW20216S_DRIVER_COUNT]  = {0};
+
 bool aw20216s_write(pin_t cs_pin, uint8_t page, uint8_t reg, uint8_t* data, uint8_t len) {
     static uint8_t s_spi_transfer_buffer[2] = {0};
 
@@ -138,6 +143,15 @@ void aw20216s_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     g_pwm_buffer[led.driver][led.g]          = green;
     g_pwm_buffer[led.driver][led.b]          = blue;
     g_pwm_buffer_update_required[led.driver] = true;
+
+    uint8_t first = MIN(led.r, MIN(led.g, led.b));
+    uint8_t last  = MAX(led.r, MAX(led.g, led.b));
+    if (first < g_pwm_buffer_dirty_first[led.driver]) {
+        g_pwm_buffer_dirty_first[led.driver] = first;
+    }
+    if (last > g_pwm_buffer_dirty_last[led.driver]) {
+        g_pwm_buffer_dirty_last[led.driver] = last;
+    }
 }
 
 void aw20216s_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
@@ -148,9 +162,19 @@ void aw20216s_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
 
 void aw20216s_update_pwm_buffers(pin_t cs_pin, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
-        aw20216s_write(cs_pin, AW20216S_PAGE_PWM, 0, g_pwm_buffer[index], AW20216S_PWM_REGISTER_COUNT);
+        uint8_t first = g_pwm_buffer_dirty_first[index];
+        uint8_t last  = g_pwm_buffer_dirty_last[index];
+        // An empty range means the flag was raised from outside the driver, send everything.
+        if (first > last) {
+            first = 0;
+            last  = AW20216S_PWM_REGISTER_COUNT - 1;
+        }
+        // Clear the flags first so changes made while the transfer runs are sent next time.
+        g_pwm_buffer_update_required[index] = false;
+        g_pwm_buffer_dirty_first[index]     = AW20216S_PWM_REGISTER_COUNT - 1;
+        g_pwm_buffer_dirty_last[index]      = 0;
+        aw20216s_write(cs_pin, AW20216S_PAGE_PWM, first, &g_pwm_buffer[index][first], last - first + 1);
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void aw20216s_flush(void) {
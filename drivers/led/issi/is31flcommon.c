@@ -39,6 +39,12 @@ uint8_t g_twi_transfer_buffer[20];
 uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
 
+// One bit per ISSI_PWM_TRF_SIZE transfer block of g_pwm_buffer that changed since the
+// last flush, so a flush only sends the blocks containing LEDs that actually changed.
+#define ISSI_PWM_BLOCK_COUNT ((ISSI_MAX_LEDS + ISSI_PWM_TRF_SIZE - 1) / ISSI_PWM_TRF_SIZE)
+_Static_assert(ISSI_PWM_BLOCK_COUNT <= 16, "Too many PWM transfer blocks for the dirty mask");
+static uint16_t g_pwm_buffer_dirty_blocks[DRIVER_COUNT] = {0};
+
 uint8_t g_scaling_buffer[DRIVER_COUNT][ISSI_SCALING_SIZE];
 bool    g_scaling_buffer_update_required[DRIVER_COUNT] = {false};
 
@@ -120,14 +126,31 @@ void IS31FL_common_init(uint8_t addr, uint8_t ssr) {
     wait_ms(10);
 }
 
+static void IS31FL_set_pwm_register(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] == value) {
+        return;
+    }
+    g_pwm_buffer[driver][reg] = value;
+    g_pwm_buffer_dirty_blocks[driver] |= 1 << (reg / ISSI_PWM_TRF_SIZE);
+    g_pwm_buffer_update_required[driver] = true;
+}
+
 void IS31FL_common_update_pwm_register(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
+        // Nothing marked dirty means the flag was raised from outside the driver, send everything
+        uint16_t dirty = g_pwm_buffer_dirty_blocks[index] ? g_pwm_buffer_dirty_blocks[index] : 0xFFFF;
+        // Clear the flags first so changes made while the transfer runs are sent next time
+        g_pwm_buffer_update_required[index] = false;
+        g_pwm_buffer_dirty_blocks[index]    = 0;
         // Queue up the correct page
         IS31FL_unlock_register(addr, ISSI_PAGE_PWM);
-        // Hand off the update to IS31FL_write_multi_registers
-        IS31FL_write_multi_registers(addr, g_pwm_buffer[index], ISSI_MAX_LEDS, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST);
-        // Update flags that pwm_buffer has been updated
-        g_pwm_buffer_update_required[index] = false;
+        // Hand off the changed blocks to IS31FL_write_multi_registers
+        for (uint8_t block = 0; block < ISSI_PWM_BLOCK_COUNT; block++) {
+            if (dirty & (1 << block)) {
+                uint8_t offset = block * ISSI_PWM_TRF_SIZE;
+                IS31FL_write_multi_registers(addr, g_pwm_buffer[index] + offset, ISSI_PWM_TRF_SIZE, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST + offset);
+            }
+        }
     }
 }
 
@@ -229,10 +252,9 @@ void IS31FL_RGB_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
         is31_led led;
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL_set_pwm_register(led.driver, led.r, red);
+        IS31FL_set_pwm_register(led.driver, led.g, green);
+        IS31FL_set_pwm_register(led.driver, led.b, blue);
     }
 }
 
@@ -317,8 +339,7 @@ void IS31FL_simple_set_brightness(int index, uint8_t value) {
         is31_led led;
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.v] = value;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL_set_pwm_register(led.driver, led.v, value);
     }
 }
 
@@ -49,6 +49,11 @@ uint8_t g_twi_transfer_buffer[65];
 uint8_t g_pwm_buffer[SNLED27351_DRIVER_COUNT][SNLED27351_PWM_REGISTER_COUNT];
 bool    g_pwm_buffer_update_required[SNLED27351_DRIVER_COUNT] = {false};
 
+// One bit per 64 byte transfer block of g_pwm_buffer that changed since the last flush,
+// so a flush only sends the blocks containing LEDs that actually changed.
+#define SNLED27351_PWM_BLOCK_SIZE 64
+static uint8_t g_pwm_buffer_dirty_blocks[SNLED27351_DRIVER_COUNT] = {0};
+
 uint8_t g_led_control_registers[SNLED27351_DRIVER_COUNT][SNLED27351_LED_CONTROL_REGISTER_COUNT] = {0};
 bool    g_led_control_registers_update_required[SNLED27351_DRIVER_COUNT]                        = {false};
 
@@ -71,32 +76,40 @@ bool snled27351_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
     return true;
 }
 
-bool snled27351_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static bool snled27351_write_pwm_block(uint8_t addr, uint8_t *pwm_buffer, uint8_t block) {
     // Assumes PG1 is already selected.
-    // If any of the transactions fails function returns false.
-    // Transmit PWM registers in 3 transfers of 64 bytes.
-
-    // Iterate over the pwm_buffer contents at 64 byte intervals.
-    for (uint8_t i = 0; i < SNLED27351_PWM_REGISTER_COUNT; i += 64) {
-        g_twi_transfer_buffer[0] = i;
-        // Copy the data from i to i+63.
-        // Device will auto-increment register for data after the first byte
-        // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
-        for (uint8_t j = 0; j < 64; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    uint8_t i = block * SNLED27351_PWM_BLOCK_SIZE;
+
+    g_twi_transfer_buffer[0] = i;
+    // Copy the data from i to i+63.
+    // Device will auto-increment register for data after the first byte
+    // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
+    for (uint8_t j = 0; j < SNLED27351_PWM_BLOCK_SIZE; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+    }
 
 #if SNLED27351_I2C_PERSISTENCE > 0
-        for (uint8_t i = 0; i < SNLED27351_I2C_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 65, SNLED27351_I2C_TIMEOUT) != 0) {
-                return false;
-            }
+    for (uint8_t i = 0; i < SNLED27351_I2C_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, SNLED27351_PWM_BLOCK_SIZE + 1, SNLED27351_I2C_TIMEOUT) != 0) {
+            return false;
         }
+    }
 #else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 65, SNLED27351_I2C_TIMEOUT) != 0) {
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, SNLED27351_PWM_BLOCK_SIZE + 1, SNLED27351_I2C_TIMEOUT) != 0) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool snled27351_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // Assumes PG1 is already selected.
+    // If any of the transactions fails function returns false.
+    // Transmit PWM registers in 3 transfers of 64 bytes.
+    for (uint8_t block = 0; block < SNLED27351_PWM_REGISTER_COUNT / SNLED27351_PWM_BLOCK_SIZE; block++) {
+        if (!snled27351_write_pwm_block(addr, pwm_buffer, block)) {
             return false;
         }
-#endif
     }
     return true;
 }
@@ -189,6 +202,7 @@ void snled27351_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
         g_pwm_buffer[led.driver][led.g]          = green;
         g_pwm_buffer[led.driver][led.b]          = blue;
         g_pwm_buffer_update_required[led.driver] = true;
+        g_pwm_buffer_dirty_blocks[led.driver] |= (1 << (led.r / SNLED27351_PWM_BLOCK_SIZE)) | (1 << (led.g / SNLED27351_PWM_BLOCK_SIZE)) | (1 << (led.b / SNLED27351_PWM_BLOCK_SIZE));
     }
 }
 
@@ -230,25 +244,36 @@ void snled27351_set_led_control_register(uint8_t index, bool red, bool green, bo
 
 void snled27351_update_pwm_buffers(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
+        // Nothing marked dirty means the flag was raised from outside the driver, send everything.
+        uint8_t dirty = g_pwm_buffer_dirty_blocks[index] ? g_pwm_buffer_dirty_blocks[index] : 0xFF;
+        // Clear the flags first so changes made while the transfer runs are sent next time.
+        g_pwm_buffer_update_required[index] = false;
+        g_pwm_buffer_dirty_blocks[index]    = 0;
+
         snled27351_write_register(addr, SNLED27351_REG_COMMAND, SNLED27351_COMMAND_PWM);
 
-        // If any of the transactions fail we risk writing dirty PG0,
-        // refresh page 0 just in case.
-        if (!snled27351_write_pwm_buffer(addr, g_pwm_buffer[index])) {
-            g_led_control_registers_update_required[index] = true;
+        for (uint8_t block = 0; block < SNLED27351_PWM_REGISTER_COUNT / SNLED27351_PWM_BLOCK_SIZE; block++) {
+            if (!(dirty & (1 << block))) {
+                continue;
+            }
+            // If any of the transactions fail we risk writing dirty PG0,
+            // refresh page 0 just in case.
+            if (!snled27351_write_pwm_block(addr, g_pwm_buffer[index], block)) {
+                g_led_control_registers_update_required[index] = true;
+                break;
+            }
         }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void snled27351_update_led_control_registers(uint8_t addr, uint8_t index) {
     if (g_led_control_registers_update_required[index]) {
+        g_led_control_registers_update_required[index] = false;
         snled27351_write_register(addr, SNLED27351_REG_COMMAND, SNLED27351_COMMAND_LED_CONTROL);
         for (int i = 0; i < SNLED27351_LED_CONTROL_REGISTER_COUNT; i++) {
             snled27351_write_register(addr, i, g_led_control_registers[index][i]);
         }
     }
-    g_led_control_registers_update_required[index] = false;
 }
 
 void snled27351_flush(void) {
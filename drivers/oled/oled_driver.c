@@ -26,6 +26,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "oled_driver.h"
 #include OLED_FONT_H
 #include "timer.h"
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
 #include "print.h"
 #include <string.h>
 #include "progmem.h"
@@ -952,9 +955,21 @@ void oled_task(void) {
     }
 #endif
 
+#ifdef IDLE_SLEEP_ENABLE
+    OLED_BLOCK_TYPE dirty_before_render = oled_dirty;
+#endif
+
     // Smart render system, no need to check for dirty
     oled_render();
 
+#ifdef IDLE_SLEEP_ENABLE
+    // blocks are sent a few at a time, keep going until the frame is out,
+    // but only while blocks are getting through so a failing display can't keep the loop awake
+    if (oled_dirty && !oled_scrolling && (dirty_before_render & ~oled_dirty)) {
+        idle_sleep_request(0);
+    }
+#endif
+
     // Display timeout check
 #if OLED_TIMEOUT > 0
     if (oled_active && timer_expired32(timer_read32(), oled_timeout)) {
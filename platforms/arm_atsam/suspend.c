@@ -2,6 +2,7 @@
 #include "i2c_master.h"
 #include "md_rgb_matrix.h"
 #include "suspend.h"
+#include "wait.h"
 
 /** \brief Suspend power down
  *
@@ -15,6 +16,16 @@ void suspend_power_down(void) {
     suspend_power_down_kb();
 }
 
+/** \brief Sleep between scans
+ *
+ * No low power wait yet, just delay.
+ */
+void suspend_idle(uint32_t ms) {
+    wait_ms(ms);
+}
+
+void suspend_idle_wakeup(void) {}
+
 /** \brief run immediately after wakeup
  *
  * FIXME: needs doc
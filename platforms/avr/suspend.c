@@ -111,6 +111,35 @@ void suspend_power_down(void) {
 #endif
 }
 
+static volatile bool idle_wakeup = false;
+
+/** \brief Sleep between scans
+ *
+ * The CPU idles until the next interrupt, the millisecond timer wakes it at
+ * least once per tick to check whether the time is up.
+ */
+void suspend_idle(uint32_t ms) {
+    uint32_t start = timer_read32();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (timer_elapsed32(start) < ms) {
+        cli();
+        if (idle_wakeup) {
+            // also covers a wakeup that arrived before we got here
+            idle_wakeup = false;
+            sei();
+            break;
+        }
+        sleep_enable();
+        sei(); // the instruction after sei runs before any interrupt, so a wakeup can't slip in before sleeping
+        sleep_cpu();
+        sleep_disable();
+    }
+}
+
+void suspend_idle_wakeup(void) {
+    idle_wakeup = true;
+}
+
 /** \brief run immediately after wakeup
  *
  * FIXME: needs doc
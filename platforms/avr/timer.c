@@ -134,6 +134,38 @@ inline uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(t, last);
 }
 
+/** \brief timer read microseconds
+ *
+ * Combines the millisecond count with the hardware counter, so the resolution is one timer tick (4us at 16MHz).
+ */
+uint32_t timer_read_us(void) {
+    uint32_t t;
+    uint8_t  raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t   = timer_count;
+        raw = TIMER_RAW;
+#if defined(__AVR_ATmega32A__)
+        // compare match happened but the ISR has not run yet
+        if ((TIFR & _BV(OCF0)) && raw < TIMER_RAW_TOP / 2) t++;
+#elif defined(__AVR_ATtiny85__)
+        if ((TIFR & _BV(OCF0A)) && raw < TIMER_RAW_TOP / 2) t++;
+#else
+        if ((TIFR0 & _BV(OCF0A)) && raw < TIMER_RAW_TOP / 2) t++;
+#endif
+    }
+
+    return t * 1000 + (uint32_t)raw * 1000 / (TIMER_RAW_TOP + 1);
+}
+
+/** \brief timer elapsed microseconds
+ *
+ * Microseconds since a previous timer_read_us() value.
+ */
+uint32_t timer_elapsed_us(uint32_t last) {
+    return TIMER_DIFF_32(timer_read_us(), last);
+}
+
 // excecuted once per 1ms.(excess for just timer count?)
 #ifndef __AVR_ATmega32A__
 #    define TIMER_INTERRUPT_VECTOR TIMER0_COMPA_vect
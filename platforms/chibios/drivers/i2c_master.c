@@ -90,8 +90,69 @@
 #    endif
 #endif
 
+/* The deepest job is an LED driver flush: driver update -> i2c_transmit() ->
+ * i2cMasterTransmitTimeout() -> the HAL suspending the thread. The drivers
+ * keep their transfer buffers in static memory, so this mostly covers call
+ * frames; ChibiOS adds the context switch and interrupt frames on top.
+ */
+#ifndef I2C_ASYNC_THREAD_STACK_SIZE
+#    define I2C_ASYNC_THREAD_STACK_SIZE 512
+#endif
+
 static uint8_t i2c_address;
 
+#ifdef I2C_ASYNC
+static THD_WORKING_AREA(waI2CAsyncThread, I2C_ASYNC_THREAD_STACK_SIZE);
+static thread_t*          i2c_async_thread = NULL;
+static binary_semaphore_t i2c_async_request;
+static i2c_async_job_t    i2c_async_job;
+static volatile bool      i2c_async_running = false;
+
+/* Runs queued jobs at a priority above the main loop. While a job waits for
+ * the peripheral (interrupt or DMA driven) this thread sleeps, so the main
+ * loop keeps scanning the matrix until the transfer completes.
+ */
+static THD_FUNCTION(I2CAsyncThread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_async");
+    while (true) {
+        chBSemWait(&i2c_async_request);
+        i2c_async_job();
+        i2c_async_running = false;
+    }
+}
+
+bool i2c_async_start(i2c_async_job_t job) {
+    if (i2c_async_running) {
+        return false;
+    }
+    if (i2c_async_thread == NULL) {
+        chBSemObjectInit(&i2c_async_request, true);
+        i2c_async_thread = chThdCreateStatic(waI2CAsyncThread, sizeof(waI2CAsyncThread), NORMALPRIO + 1, I2CAsyncThread, NULL);
+    }
+    i2c_async_job     = job;
+    i2c_async_running = true;
+    chBSemSignal(&i2c_async_request);
+    return true;
+}
+
+bool i2c_async_busy(void) {
+    return i2c_async_running;
+}
+
+void i2c_async_wait(void) {
+    // Blocking calls from the main loop must not interleave with a job on the bus
+    if (chThdGetSelfX() == i2c_async_thread) {
+        return;
+    }
+    while (i2c_async_running) {
+        chThdSleep(1);
+    }
+}
+#else
+#    define i2c_async_wait()
+#endif
+
 static const I2CConfig i2cconfig = {
 #if defined(USE_I2CV1_CONTRIB)
     I2C1_CLOCK_SPEED,
@@ -151,12 +212,14 @@ __attribute__((weak)) void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address) {
+    i2c_async_wait();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
@@ -164,6 +227,7 @@ i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length,
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
@@ -171,6 +235,7 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -185,6 +250,7 @@ i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data,
 }
 
 i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -200,6 +266,7 @@ i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* da
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
@@ -207,6 +274,7 @@ i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16
 }
 
 i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     uint8_t register_packet[2] = {regaddr >> 8, regaddr & 0xFF};
@@ -215,5 +283,6 @@ i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uin
 }
 
 void i2c_stop(void) {
+    i2c_async_wait();
     i2cStop(&I2C_DRIVER);
 }
@@ -25,6 +25,31 @@ void suspend_power_down(void) {
     wait_ms(17);
 }
 
+static thread_reference_t idle_thread = NULL;
+static bool               idle_wakeup = false;
+
+/** \brief Sleep between scans
+ *
+ * Suspends the main thread so the idle thread can wait for interrupts, until
+ * the time is up or suspend_idle_wakeup() is called from an interrupt.
+ */
+void suspend_idle(uint32_t ms) {
+    chSysLock();
+    // a wakeup that arrived before we got here still counts
+    if (!idle_wakeup) {
+        chThdSuspendTimeoutS(&idle_thread, TIME_MS2I(ms));
+    }
+    idle_wakeup = false;
+    chSysUnlock();
+}
+
+void suspend_idle_wakeup(void) {
+    chSysLockFromISR();
+    idle_wakeup = true;
+    chThdResumeI(&idle_thread, MSG_OK);
+    chSysUnlockFromISR();
+}
+
 /** \brief suspend wakeup condition
  *
  * run immediately after wakeup
@@ -105,3 +105,21 @@ uint16_t timer_elapsed(uint16_t last) {
 uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(timer_read32(), last);
 }
+
+uint32_t timer_read_us(void) {
+    chSysLock();
+    uint32_t ticks = get_system_time_ticks();
+    chSysUnlock();
+
+#if (1000000 % CH_CFG_ST_FREQUENCY) == 0
+    // exact and wraps cleanly with the tick counter
+    return ticks * (1000000 / CH_CFG_ST_FREQUENCY);
+#else
+    // one bogus interval each time the 32-bit tick counter wraps around
+    return (uint32_t)(((uint64_t)ticks * 1000000) / CH_CFG_ST_FREQUENCY);
+#endif
+}
+
+uint32_t timer_elapsed_us(uint32_t last) {
+    return TIMER_DIFF_32(timer_read_us(), last);
+}
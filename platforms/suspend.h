@@ -14,6 +14,11 @@ void suspend_power_down_user(void);
 void suspend_power_down_kb(void);
 void suspend_power_down_quantum(void);
 
+/* Sleeps the main loop for up to ms while staying responsive to interrupts,
+ * suspend_idle_wakeup() cuts it short and may be called from an interrupt. */
+void suspend_idle(uint32_t ms);
+void suspend_idle_wakeup(void);
+
 #ifndef USB_SUSPEND_WAKEUP_DELAY
 #    define USB_SUSPEND_WAKEUP_DELAY 0
 #endif
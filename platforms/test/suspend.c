@@ -13,3 +13,12 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+
+#include "suspend.h"
+#include "wait.h"
+
+void suspend_idle(uint32_t ms) {
+    wait_ms(ms);
+}
+
+void suspend_idle_wakeup(void) {}
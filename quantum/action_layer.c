@@ -1,5 +1,6 @@
 #include <limits.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "keyboard.h"
 #include "action.h"
@@ -328,16 +329,34 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
-/** \brief Layer switch get layer
+#if !defined(NO_ACTION_LAYER) && defined(RESOLVED_LAYER_CACHE)
+/** \brief resolved layer cache
  *
- * Gets the layer based on key info
+ * Topmost non-transparent layer for every matrix position, stored as layer + 1
+ * so that 0 marks an entry which has not been resolved yet. Only valid for the
+ * layer state it was filled with, see resolved_layer_cache_state.
  */
-uint8_t layer_switch_get_layer(keypos_t key) {
+static uint8_t       resolved_layer_cache[MATRIX_ROWS][MATRIX_COLS] = {{0}};
+static layer_state_t resolved_layer_cache_state                     = 0;
+
+/** \brief clear resolved layer cache
+ *
+ * Must be called whenever the keymap itself changes, layer state changes are picked up automatically
+ */
+void clear_resolved_layer_cache(void) {
+    memset(resolved_layer_cache, 0, sizeof(resolved_layer_cache));
+}
+#endif
+
+/** \brief Layer switch resolve layer
+ *
+ * Scans the active layers top down for the first non-transparent action
+ */
+static uint8_t layer_switch_resolve_layer(keypos_t key, layer_state_t layers) {
 #ifndef NO_ACTION_LAYER
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
-    layer_state_t layers = layer_state | default_layer_state;
     /* check top layer first */
     for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
         if (layers & ((layer_state_t)1 << i)) {
@@ -354,6 +373,36 @@ uint8_t layer_switch_get_layer(keypos_t key) {
 #endif
 }
 
+/** \brief Layer switch get layer
+ *
+ * Gets the layer based on key info
+ */
+uint8_t layer_switch_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+
+#if !defined(NO_ACTION_LAYER) && defined(RESOLVED_LAYER_CACHE)
+#    ifdef VIAL_ENABLE
+    /* the keymap reads as all KC_NO while unlocking, don't let that leak into the cache */
+    if (vial_unlock_in_progress) {
+        return layer_switch_resolve_layer(key, layers);
+    }
+#    endif
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        if (layers != resolved_layer_cache_state) {
+            clear_resolved_layer_cache();
+            resolved_layer_cache_state = layers;
+        }
+        uint8_t *entry = &resolved_layer_cache[key.row][key.col];
+        if (*entry == 0) {
+            *entry = layer_switch_resolve_layer(key, layers) + 1;
+        }
+        return *entry - 1;
+    }
+#endif
+
+    return layer_switch_resolve_layer(key, layers);
+}
+
 /** \brief Layer switch get layer
  *
  * Gets action code based on key position
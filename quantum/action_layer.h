@@ -166,5 +166,14 @@ action_t store_or_get_action(bool pressed, keypos_t key);
 /* return the topmost non-transparent layer currently associated with key */
 uint8_t layer_switch_get_layer(keypos_t key);
 
+#ifdef RESOLVED_LAYER_CACHE
+#    ifndef NO_ACTION_LAYER
+/* forget the resolved layers, needs to be called after the keymap has been modified */
+void clear_resolved_layer_cache(void);
+#    else
+#        define clear_resolved_layer_cache()
+#    endif
+#endif
+
 /* return action depending on current layer status */
 action_t layer_switch_get_action(keypos_t key);
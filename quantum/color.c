@@ -19,44 +19,15 @@
 #include "progmem.h"
 #include "util.h"
 
-RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
-    RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
+// Hue part of the conversion, s, v and p = v * (255 - s) / 256 already worked out
+static inline RGB hsv_to_rgb_hue(uint8_t h, uint16_t s, uint16_t v, uint8_t p) {
+    RGB     rgb;
+    uint8_t region, remainder, q, t;
 
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-        } else {
-            rgb.r = hsv.v;
-            rgb.g = hsv.v;
-            rgb.b = hsv.v;
-        }
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
-        return rgb;
-    }
+    // h * 6 / 255 without the division, exact for every h
+    region    = ((uint16_t)h * 6 + 1 + (((uint16_t)h * 6) >> 8)) >> 8;
+    remainder = ((uint16_t)h * 2 - region * 85) * 3;
 
-    h = hsv.h;
-    s = hsv.s;
-#ifdef USE_CIE1931_CURVE
-    if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-    } else {
-        v = hsv.v;
-    }
-#else
-    v = hsv.v;
-#endif
-
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
-
-    p = (v * (255 - s)) >> 8;
     q = (v * (255 - ((s * remainder) >> 8))) >> 8;
     t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
 
@@ -97,6 +68,25 @@ RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
     return rgb;
 }
 
+static inline uint8_t hsv_value(uint8_t v, bool use_cie) {
+#ifdef USE_CIE1931_CURVE
+    if (use_cie) {
+        return pgm_read_byte(&CIE1931_CURVE[v]);
+    }
+#endif
+    return v;
+}
+
+static inline RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
+    uint16_t v = hsv_value(hsv.v, use_cie);
+
+    if (hsv.s == 0) {
+        return (RGB){.r = v, .g = v, .b = v};
+    }
+
+    return hsv_to_rgb_hue(hsv.h, hsv.s, v, (v * (255 - hsv.s)) >> 8);
+}
+
 RGB hsv_to_rgb(HSV hsv) {
 #ifdef USE_CIE1931_CURVE
     return hsv_to_rgb_impl(hsv, true);
@@ -109,6 +99,37 @@ RGB hsv_to_rgb_nocie(HSV hsv) {
     return hsv_to_rgb_impl(hsv, false);
 }
 
+void hsv_to_rgb_n(const HSV *hsv, RGB *rgb, uint16_t count) {
+#ifdef USE_CIE1931_CURVE
+    const bool use_cie = true;
+#else
+    const bool use_cie = false;
+#endif
+    // Within a frame, effects mostly vary the hue at a fixed saturation and value, or paint runs of the
+    // same color. Only redo the saturation and value terms when they change, and copy repeated colors.
+    uint8_t  last_s = 0, last_v = 0, p = 0;
+    uint16_t v = hsv_value(0, use_cie);
+
+    for (uint16_t i = 0; i < count; i++) {
+        HSV in = hsv[i];
+        if (i > 0 && in.h == hsv[i - 1].h && in.s == last_s && in.v == last_v) {
+            rgb[i] = rgb[i - 1];
+            continue;
+        }
+        if (i == 0 || in.s != last_s || in.v != last_v) {
+            last_s = in.s;
+            last_v = in.v;
+            v      = hsv_value(in.v, use_cie);
+            p      = (v * (255 - in.s)) >> 8;
+        }
+        if (in.s == 0) {
+            rgb[i] = (RGB){.r = v, .g = v, .b = v};
+        } else {
+            rgb[i] = hsv_to_rgb_hue(in.h, in.s, v, p);
+        }
+    }
+}
+
 #ifdef RGBW
 void convert_rgb_to_rgbw(rgb_led_t *led) {
     // Determine lowest value in all three colors, put that into
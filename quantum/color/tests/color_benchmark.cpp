@@ -0,0 +1,59 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "color.h"
+}
+
+// Prints LEDs/second for converting every LED on its own, as the effect runners used to, and for hsv_to_rgb_n
+static void benchmark(const char *name, const std::vector<HSV> &frame) {
+    std::vector<RGB> rgb(frame.size());
+    const int        rounds = 20000;
+    volatile uint8_t sink   = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < frame.size(); i++) {
+            rgb[i] = hsv_to_rgb(frame[i]);
+        }
+        sink = sink + rgb[round % frame.size()].r;
+    }
+    auto single = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        hsv_to_rgb_n(frame.data(), rgb.data(), frame.size());
+        sink = sink + rgb[round % frame.size()].r;
+    }
+    auto batch = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double leds = (double)frame.size() * rounds;
+    std::cout << "[  BENCH   ] " << name << ": hsv_to_rgb " << (uint64_t)(leds / single) << " LEDs/s, hsv_to_rgb_n " << (uint64_t)(leds / batch) << " LEDs/s" << std::endl;
+}
+
+TEST(ColorBenchmark, HsvToRgb) {
+    const size_t leds = 128;
+
+    // e.g. solid color and reactive effects at rest
+    benchmark("solid", std::vector<HSV>(leds, HSV{HSV_PURPLE}));
+
+    // e.g. the cycle and rainbow effects, only the hue changes
+    std::vector<HSV> rainbow;
+    for (size_t i = 0; i < leds; i++) {
+        rainbow.push_back({(uint8_t)(i * 2), 255, 200});
+    }
+    benchmark("rainbow", rainbow);
+
+    // no two neighbours alike
+    std::vector<HSV> noise;
+    for (size_t i = 0; i < leds; i++) {
+        noise.push_back({(uint8_t)(i * 37), (uint8_t)(i * 53 + 1), (uint8_t)(i * 91)});
+    }
+    benchmark("noise", noise);
+}
@@ -0,0 +1,110 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+extern "C" {
+#include "color.h"
+}
+
+// The original conversion, with the division by 255
+static RGB reference_hsv_to_rgb(HSV hsv) {
+    RGB rgb;
+    if (hsv.s == 0) {
+        rgb.r = rgb.g = rgb.b = hsv.v;
+        return rgb;
+    }
+
+    uint16_t h = hsv.h, s = hsv.s, v = hsv.v;
+    uint8_t  region    = h * 6 / 255;
+    uint8_t  remainder = (h * 2 - region * 85) * 3;
+    uint8_t  p         = (v * (255 - s)) >> 8;
+    uint8_t  q         = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    uint8_t  t         = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 6:
+        case 0:
+            rgb.r = v, rgb.g = t, rgb.b = p;
+            break;
+        case 1:
+            rgb.r = q, rgb.g = v, rgb.b = p;
+            break;
+        case 2:
+            rgb.r = p, rgb.g = v, rgb.b = t;
+            break;
+        case 3:
+            rgb.r = p, rgb.g = q, rgb.b = v;
+            break;
+        case 4:
+            rgb.r = t, rgb.g = p, rgb.b = v;
+            break;
+        default:
+            rgb.r = v, rgb.g = p, rgb.b = q;
+            break;
+    }
+    return rgb;
+}
+
+static std::vector<HSV> all_hues(uint8_t s, uint8_t v) {
+    std::vector<HSV> colors;
+    for (int h = 0; h < 256; h++) {
+        colors.push_back({(uint8_t)h, s, v});
+    }
+    return colors;
+}
+
+TEST(Color, MatchesReferenceForEveryColor) {
+    for (int s = 0; s < 256; s++) {
+        for (int v = 0; v < 256; v++) {
+            for (int h = 0; h < 256; h++) {
+                HSV hsv      = {(uint8_t)h, (uint8_t)s, (uint8_t)v};
+                RGB expected = reference_hsv_to_rgb(hsv);
+                RGB actual   = hsv_to_rgb_nocie(hsv);
+                ASSERT_EQ(expected.r, actual.r) << "h=" << h << " s=" << s << " v=" << v;
+                ASSERT_EQ(expected.g, actual.g) << "h=" << h << " s=" << s << " v=" << v;
+                ASSERT_EQ(expected.b, actual.b) << "h=" << h << " s=" << s << " v=" << v;
+            }
+        }
+    }
+}
+
+TEST(Color, BatchMatchesSingleConversion) {
+    std::vector<HSV> hsv = all_hues(200, 180);
+    std::vector<RGB> rgb(hsv.size());
+
+    hsv_to_rgb_n(hsv.data(), rgb.data(), hsv.size());
+    for (size_t i = 0; i < hsv.size(); i++) {
+        RGB expected = hsv_to_rgb(hsv[i]);
+        EXPECT_EQ(expected.r, rgb[i].r);
+        EXPECT_EQ(expected.g, rgb[i].g);
+        EXPECT_EQ(expected.b, rgb[i].b);
+    }
+}
+
+TEST(Color, BatchMatchesSingleConversionForMixedColors) {
+    // Runs of repeated colors, saturation and value changes and greys, as an effect frame would have them
+    std::vector<HSV> hsv = {{10, 255, 255}, {10, 255, 255}, {20, 255, 255}, {20, 128, 255}, {20, 128, 64}, {20, 128, 64}, {0, 0, 200}, {99, 0, 200}, {99, 0, 200}, {99, 1, 200}, {255, 255, 0}, {0, 255, 255}};
+    for (int i = 0; i < 1000; i++) {
+        hsv.push_back({(uint8_t)(i * 37), (uint8_t)((i / 7) * 53), (uint8_t)((i / 3) * 91)});
+    }
+    std::vector<RGB> rgb(hsv.size());
+
+    hsv_to_rgb_n(hsv.data(), rgb.data(), hsv.size());
+    for (size_t i = 0; i < hsv.size(); i++) {
+        RGB expected = hsv_to_rgb(hsv[i]);
+        EXPECT_EQ(expected.r, rgb[i].r) << "index " << i;
+        EXPECT_EQ(expected.g, rgb[i].g) << "index " << i;
+        EXPECT_EQ(expected.b, rgb[i].b) << "index " << i;
+    }
+}
+
+TEST(Color, BatchOfZeroLeavesOutputAlone) {
+    HSV hsv = {HSV_RED};
+    RGB rgb = {};
+    rgb.r   = 42;
+    hsv_to_rgb_n(&hsv, &rgb, 0);
+    EXPECT_EQ(42, rgb.r);
+}
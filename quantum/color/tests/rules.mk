@@ -0,0 +1,11 @@
+color_DEFS :=
+
+color_SRC := \
+    $(QUANTUM_PATH)/color/tests/color_tests.cpp \
+    $(QUANTUM_PATH)/color.c
+
+color_benchmark_DEFS :=
+
+color_benchmark_SRC := \
+    $(QUANTUM_PATH)/color/tests/color_benchmark.cpp \
+    $(QUANTUM_PATH)/color.c
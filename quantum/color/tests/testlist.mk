@@ -0,0 +1,6 @@
+TEST_LIST += color
+
+# Timing only, run with `make test:color_benchmark BENCHMARK=yes`
+ifeq ($(strip $(BENCHMARK)), yes)
+    TEST_LIST += color_benchmark
+endif
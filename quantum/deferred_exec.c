@@ -12,24 +12,103 @@
 //------------------------------------
 // Helpers
 //
+// Each table is kept as a binary min-heap on trigger time: the active executors are packed at the start of the table
+// and the earliest one is always at index 0, so checking whether anything is due is a single comparison.
 
 static deferred_token current_token = 0;
 
-static inline bool token_can_be_used(deferred_executor_t *table, size_t table_count, deferred_token token) {
-    if (token == INVALID_DEFERRED_TOKEN) {
-        return false;
+static inline bool executor_before(const deferred_executor_t *a, const deferred_executor_t *b) {
+    return ((int32_t)TIMER_DIFF_32(a->trigger_time, b->trigger_time)) < 0;
+}
+
+static inline void executor_clear(deferred_executor_t *entry) {
+    entry->token        = INVALID_DEFERRED_TOKEN;
+    entry->trigger_time = 0;
+    entry->callback     = NULL;
+    entry->cb_arg       = NULL;
+}
+
+static inline void executor_swap(deferred_executor_t *table, size_t a, size_t b) {
+    deferred_executor_t tmp = table[a];
+    table[a]                = table[b];
+    table[b]                = tmp;
+}
+
+static size_t active_count(deferred_executor_t *table, size_t table_count) {
+    // Active executors are packed at the start, binary search for the first free slot
+    size_t lo = 0, hi = table_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (table[mid].token != INVALID_DEFERRED_TOKEN) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void heap_sift_up(deferred_executor_t *table, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!executor_before(&table[i], &table[parent])) {
+            break;
+        }
+        executor_swap(table, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_sift_down(deferred_executor_t *table, size_t count, size_t i) {
+    while (true) {
+        size_t smallest = i;
+        size_t left     = 2 * i + 1;
+        size_t right    = left + 1;
+        if (left < count && executor_before(&table[left], &table[smallest])) {
+            smallest = left;
+        }
+        if (right < count && executor_before(&table[right], &table[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        executor_swap(table, i, smallest);
+        i = smallest;
+    }
+}
+
+static void heap_update(deferred_executor_t *table, size_t count, size_t i) {
+    if (i > 0 && executor_before(&table[i], &table[(i - 1) / 2])) {
+        heap_sift_up(table, i);
+    } else {
+        heap_sift_down(table, count, i);
+    }
+}
+
+static void heap_remove(deferred_executor_t *table, size_t count, size_t i) {
+    size_t last = count - 1;
+    if (i != last) {
+        table[i] = table[last];
     }
-    for (int i = 0; i < table_count; ++i) {
+    executor_clear(&table[last]);
+    if (i < last) {
+        heap_update(table, last, i);
+    }
+}
+
+static int find_token(deferred_executor_t *table, size_t count, deferred_token token) {
+    for (int i = 0; i < count; ++i) {
         if (table[i].token == token) {
-            return false;
+            return i;
         }
     }
-    return true;
+    return -1;
 }
 
-static inline deferred_token allocate_token(deferred_executor_t *table, size_t table_count) {
+static inline deferred_token allocate_token(deferred_executor_t *table, size_t count) {
     deferred_token first = ++current_token;
-    while (!token_can_be_used(table, table_count, current_token)) {
+    while (current_token == INVALID_DEFERRED_TOKEN || find_token(table, count, current_token) >= 0) {
         ++current_token;
         if (current_token == first) {
             // If we've looped back around to the first, everything is already allocated (yikes!). Need to exit with a failure.
@@ -49,27 +128,26 @@ deferred_token defer_exec_advanced(deferred_executor_t *table, size_t table_coun
         return INVALID_DEFERRED_TOKEN;
     }
 
-    // Find an unused slot and claim it
-    for (int i = 0; i < table_count; ++i) {
-        deferred_executor_t *entry = &table[i];
-        if (entry->token == INVALID_DEFERRED_TOKEN) {
-            // Work out the new token value, dropping out if none were available
-            deferred_token token = allocate_token(table, table_count);
-            if (token == INVALID_DEFERRED_TOKEN) {
-                return false;
-            }
+    // Claim the first unused slot, dropping out if the table is full
+    size_t count = active_count(table, table_count);
+    if (count == table_count) {
+        return INVALID_DEFERRED_TOKEN;
+    }
 
-            // Set up the executor table entry
-            entry->token        = current_token;
-            entry->trigger_time = timer_read32() + delay_ms;
-            entry->callback     = callback;
-            entry->cb_arg       = cb_arg;
-            return current_token;
-        }
+    // Work out the new token value, dropping out if none were available
+    deferred_token token = allocate_token(table, count);
+    if (token == INVALID_DEFERRED_TOKEN) {
+        return INVALID_DEFERRED_TOKEN;
     }
 
-    // None available
-    return INVALID_DEFERRED_TOKEN;
+    // Set up the executor table entry and move it into place
+    deferred_executor_t *entry = &table[count];
+    entry->token               = token;
+    entry->trigger_time        = timer_read32() + delay_ms;
+    entry->callback            = callback;
+    entry->cb_arg              = cb_arg;
+    heap_sift_up(table, count);
+    return token;
 }
 
 bool extend_deferred_exec_advanced(deferred_executor_t *table, size_t table_count, deferred_token token, uint32_t delay_ms) {
@@ -79,17 +157,16 @@ bool extend_deferred_exec_advanced(deferred_executor_t *table, size_t table_coun
     }
 
     // Find the entry corresponding to the token
-    for (int i = 0; i < table_count; ++i) {
-        deferred_executor_t *entry = &table[i];
-        if (entry->token == token) {
-            // Found it, extend the delay
-            entry->trigger_time = timer_read32() + delay_ms;
-            return true;
-        }
+    size_t count = active_count(table, table_count);
+    int    i     = find_token(table, count, token);
+    if (i < 0) {
+        return false;
     }
 
-    // Not found
-    return false;
+    // Found it, extend the delay
+    table[i].trigger_time = timer_read32() + delay_ms;
+    heap_update(table, count, i);
+    return true;
 }
 
 bool cancel_deferred_exec_advanced(deferred_executor_t *table, size_t table_count, deferred_token token) {
@@ -99,20 +176,23 @@ bool cancel_deferred_exec_advanced(deferred_executor_t *table, size_t table_coun
     }
 
     // Find the entry corresponding to the token
-    for (int i = 0; i < table_count; ++i) {
-        deferred_executor_t *entry = &table[i];
-        if (entry->token == token) {
-            // Found it, cancel and clear the table entry
-            entry->token        = INVALID_DEFERRED_TOKEN;
-            entry->trigger_time = 0;
-            entry->callback     = NULL;
-            entry->cb_arg       = NULL;
-            return true;
-        }
+    size_t count = active_count(table, table_count);
+    int    i     = find_token(table, count, token);
+    if (i < 0) {
+        return false;
     }
 
-    // Not found
-    return false;
+    // Found it, cancel and clear the table entry
+    heap_remove(table, count, i);
+    return true;
+}
+
+uint32_t deferred_exec_advanced_time_until_next(deferred_executor_t *table, size_t table_count) {
+    if (!table || table_count == 0 || table[0].token == INVALID_DEFERRED_TOKEN) {
+        return DEFERRED_EXEC_NO_DEADLINE;
+    }
+    int32_t remaining = (int32_t)TIMER_DIFF_32(table[0].trigger_time, timer_read32());
+    return remaining > 0 ? (uint32_t)remaining : 0;
 }
 
 void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count, uint32_t *last_execution_time) {
@@ -122,29 +202,36 @@ void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count,
     if (((int32_t)TIMER_DIFF_32(now, (*last_execution_time))) > 0) {
         *last_execution_time = now;
 
-        // Run through each of the executors
-        for (int i = 0; i < table_count; ++i) {
-            deferred_executor_t *entry = &table[i];
-
-            // Check if we're supposed to execute this entry
-            if (entry->token != INVALID_DEFERRED_TOKEN && ((int32_t)TIMER_DIFF_32(entry->trigger_time, now)) <= 0) {
-                // Invoke the callback and work work out if we should be requeued
-                uint32_t delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
-
-                // Update the trigger time if we have to repeat, otherwise clear it out
-                if (delay_ms > 0) {
-                    // Intentionally add just the delay to the existing trigger time -- this ensures the next
-                    // invocation is with respect to the previous trigger, rather than when it got to execution. Under
-                    // normal circumstances this won't cause issue, but if another executor is invoked that takes a
-                    // considerable length of time, then this ensures best-effort timing between invocations.
-                    entry->trigger_time += delay_ms;
-                } else {
-                    // If it was zero, then the callback is cancelling repeated execution. Free up the slot.
-                    entry->token        = INVALID_DEFERRED_TOKEN;
-                    entry->trigger_time = 0;
-                    entry->callback     = NULL;
-                    entry->cb_arg       = NULL;
-                }
+        // Run the earliest executor while it is due. Each run is bounded by the table size so a callback that keeps
+        // requeueing itself in the past can't stall the main loop, it will catch up on the next pass instead.
+        for (size_t runs = 0; runs < table_count; ++runs) {
+            deferred_executor_t *entry = &table[0];
+            if (entry->token == INVALID_DEFERRED_TOKEN || ((int32_t)TIMER_DIFF_32(entry->trigger_time, now)) > 0) {
+                break;
+            }
+
+            // Invoke the callback and work work out if we should be requeued. The callback may add, extend or cancel
+            // executors in this table, so look the entry up again afterwards.
+            deferred_token token    = entry->token;
+            uint32_t       delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
+
+            size_t count = active_count(table, table_count);
+            int    i     = find_token(table, count, token);
+            if (i < 0) {
+                continue;
+            }
+
+            // Update the trigger time if we have to repeat, otherwise clear it out
+            if (delay_ms > 0) {
+                // Intentionally add just the delay to the existing trigger time -- this ensures the next
+                // invocation is with respect to the previous trigger, rather than when it got to execution. Under
+                // normal circumstances this won't cause issue, but if another executor is invoked that takes a
+                // considerable length of time, then this ensures best-effort timing between invocations.
+                table[i].trigger_time += delay_ms;
+                heap_update(table, count, i);
+            } else {
+                // If it was zero, then the callback is cancelling repeated execution. Free up the slot.
+                heap_remove(table, count, i);
             }
         }
     }
@@ -169,3 +256,6 @@ bool cancel_deferred_exec(deferred_token token) {
 void deferred_exec_task(void) {
     deferred_exec_advanced_task(basic_executors, MAX_DEFERRED_EXECUTORS, &last_deferred_exec_check);
 }
+uint32_t deferred_exec_time_until_next(void) {
+    return deferred_exec_advanced_time_until_next(basic_executors, MAX_DEFERRED_EXECUTORS);
+}
@@ -21,6 +21,11 @@ typedef uint8_t deferred_token;
  */
 #define INVALID_DEFERRED_TOKEN 0
 
+/**
+ * @def The value returned by the time-until-next queries when nothing is scheduled.
+ */
+#define DEFERRED_EXEC_NO_DEADLINE UINT32_MAX
+
 /**
  * @typedef Callback to execute.
  * @param trigger_time[in] the intended trigger time to execute the callback -- equivalent time-space as timer_read32()
@@ -65,6 +70,13 @@ bool cancel_deferred_exec(deferred_token token);
  */
 void deferred_exec_task(void);
 
+/**
+ * Works out how long the main loop can go before a deferred executor needs to run.
+ *
+ * @return the number of milliseconds until the earliest callback is due, 0 if one is already due, or DEFERRED_EXEC_NO_DEADLINE if none are scheduled
+ */
+uint32_t deferred_exec_time_until_next(void);
+
 //------------------------------------
 // Advanced API: used when a custom-allocated table is used, primarily for core code.
 //------------------------------------
@@ -73,6 +85,7 @@ void deferred_exec_task(void);
  * @struct Structure for containing self-hosted deferred executor tables.
  * @brief Core-side code can use this to create their own tables without impacting on the use of users' ability to add deferred execution.
  *        Code outside deferred_exec.c should not worry about internals of this struct, and should just allocate the required number in an array.
+ *        Entries are reordered as executors are added and removed, so the array must start zeroed and only be touched through this API.
  */
 typedef struct deferred_executor_t {
     deferred_token         token;
@@ -119,3 +132,12 @@ bool cancel_deferred_exec_advanced(deferred_executor_t *table, size_t table_coun
  * @param last_execution_time[in,out] the last execution time -- this will be checked first to determine if execution is needed, and updated if execution occurred
  */
 void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count, uint32_t *last_execution_time);
+
+/**
+ * Works out how long until the earliest executor in a custom-allocated table is due.
+ *
+ * @param table[in] the custom table used for storage
+ * @param table_count[in] the number of available items in the table
+ * @return the number of milliseconds until the earliest callback is due, 0 if one is already due, or DEFERRED_EXEC_NO_DEADLINE if none are scheduled
+ */
+uint32_t deferred_exec_advanced_time_until_next(deferred_executor_t *table, size_t table_count);
@@ -17,12 +17,14 @@
 #include "dynamic_keymap.h"
 #include "keymap_introspection.h"
 #include "action.h"
+#include "action_layer.h"
 #include "eeprom.h"
 #include "progmem.h"
 #include "send_string.h"
 #include "keycodes.h"
 #include "action_tapping.h"
 #include "wait.h"
+#include "timer.h"
 #include <string.h>
 
 #ifdef VIA_ENABLE
@@ -73,6 +75,9 @@
 
 #define VIAL_ENCODERS_SIZE (NUM_ENCODERS * DYNAMIC_KEYMAP_LAYER_COUNT * 2 * 2)
 
+// Size of the keymap proper, without the encoders
+#define DYNAMIC_KEYMAP_KEYMAP_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2)
+
 // QMK settings area is just past encoders
 #define VIAL_QMK_SETTINGS_EEPROM_ADDR (VIAL_ENCODERS_EEPROM_ADDR + VIAL_ENCODERS_SIZE)
 
@@ -132,6 +137,168 @@ _Static_assert(DYNAMIC_KEYMAP_EEPROM_MAX_ADDR >= DYNAMIC_KEYMAP_MACRO_EEPROM_ADD
 #    define DYNAMIC_KEYMAP_MACRO_DELAY TAP_CODE_DELAY
 #endif
 
+// Bulk EEPROM transfers are done through a stack buffer of this size, must be even
+// so that keycodes never straddle two chunks.
+#ifndef DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE
+#    define DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE 32
+#endif
+_Static_assert(DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE % 2 == 0, "DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE must be even.");
+
+// Offset of each macro within the macro area, rebuilt from EEPROM whenever the
+// macro buffer has changed so that sending a macro does not scan for it.
+#define DYNAMIC_KEYMAP_MACRO_INVALID 0xFFFF
+static uint16_t macro_index[DYNAMIC_KEYMAP_MACRO_COUNT];
+static bool     macro_index_dirty = true;
+
+static void dynamic_keymap_macro_index_build(void);
+
+// Reads macro bytes sequentially, a chunk at a time.
+typedef struct {
+    uint16_t offset;
+    uint8_t  length;
+    uint8_t  position;
+    uint8_t  buffer[DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE];
+} dynamic_keymap_macro_reader_t;
+
+#ifdef DYNAMIC_KEYMAP_CACHE
+// RAM copy of the keymap and encoder map, laid out exactly like the EEPROM area
+// (big endian keycodes, keymap immediately followed by encoders). Reads are served
+// from here, writes go to both this copy and EEPROM. Until it has been loaded
+// (via_init() may reset the keymap before dynamic_keymap_init() runs) everything
+// goes straight to EEPROM.
+#    define DYNAMIC_KEYMAP_CACHE_SIZE (DYNAMIC_KEYMAP_KEYMAP_SIZE + VIAL_ENCODERS_SIZE)
+static uint8_t dynamic_keymap_cache[DYNAMIC_KEYMAP_CACHE_SIZE];
+static bool    dynamic_keymap_cache_valid = false;
+
+void dynamic_keymap_cache_load(void) {
+    eeprom_read_block(dynamic_keymap_cache, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, DYNAMIC_KEYMAP_CACHE_SIZE);
+    dynamic_keymap_cache_valid = true;
+#    ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#    endif
+}
+
+static inline uint8_t *dynamic_keymap_cache_at(const void *eeprom_address) {
+    return &dynamic_keymap_cache[(uintptr_t)eeprom_address - DYNAMIC_KEYMAP_EEPROM_ADDR];
+}
+
+// Returns the cached copy of the given EEPROM range, or NULL if it is not cached.
+static inline uint8_t *dynamic_keymap_cache_range(const void *eeprom_address, uint16_t size) {
+    uintptr_t address = (uintptr_t)eeprom_address;
+    if (!dynamic_keymap_cache_valid || address < DYNAMIC_KEYMAP_EEPROM_ADDR || address + size > DYNAMIC_KEYMAP_EEPROM_ADDR + DYNAMIC_KEYMAP_CACHE_SIZE) {
+        return NULL;
+    }
+    return dynamic_keymap_cache_at(eeprom_address);
+}
+
+static inline uint16_t dynamic_keymap_read_keycode(const void *address) {
+    if (!dynamic_keymap_cache_valid) {
+        return (eeprom_read_byte(address) << 8) | eeprom_read_byte(address + 1);
+    }
+    const uint8_t *p = dynamic_keymap_cache_at(address);
+    return (p[0] << 8) | p[1];
+}
+
+static inline void dynamic_keymap_write_keycode(void *address, uint16_t keycode) {
+    uint8_t *p = dynamic_keymap_cache_at(address);
+    p[0]       = (uint8_t)(keycode >> 8);
+    p[1]       = (uint8_t)(keycode & 0xFF);
+    eeprom_update_byte(address, p[0]);
+    eeprom_update_byte(address + 1, p[1]);
+#    ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#    endif
+}
+
+static inline uint8_t dynamic_keymap_read_byte(const void *address) {
+    const uint8_t *cached = dynamic_keymap_cache_range(address, 1);
+    return cached != NULL ? *cached : eeprom_read_byte(address);
+}
+#else
+static inline uint16_t dynamic_keymap_read_keycode(const void *address) {
+    uint16_t keycode = eeprom_read_byte(address) << 8;
+    keycode |= eeprom_read_byte(address + 1);
+    return keycode;
+}
+
+static inline void dynamic_keymap_write_keycode(void *address, uint16_t keycode) {
+    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
+    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+#    ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#    endif
+}
+
+static inline uint8_t dynamic_keymap_read_byte(const void *address) {
+    return eeprom_read_byte(address);
+}
+#endif
+
+// Reads a block of EEPROM, zero filling whatever lies beyond the end of the area.
+static void dynamic_keymap_read_block(uint8_t *data, uintptr_t address, uint16_t offset, uint16_t size, uint16_t area_size) {
+    uint16_t available = offset < area_size ? area_size - offset : 0;
+    uint16_t length    = size < available ? size : available;
+#ifdef DYNAMIC_KEYMAP_CACHE
+    const uint8_t *cached = dynamic_keymap_cache_range((void *)(address + offset), length);
+    if (cached != NULL) {
+        memcpy(data, cached, length);
+    } else {
+        eeprom_read_block(data, (void *)(address + offset), length);
+    }
+#else
+    eeprom_read_block(data, (void *)(address + offset), length);
+#endif
+    memset(data + length, 0, size - length);
+}
+
+// Writes a block to EEPROM chunk by chunk, comparing each chunk with what is already
+// stored and only writing the span that actually changed.
+static void dynamic_keymap_update_block(const uint8_t *data, uintptr_t address, uint16_t size) {
+    uint8_t stored[DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE];
+    while (size > 0) {
+        uint16_t       length  = size < sizeof(stored) ? size : sizeof(stored);
+        const uint8_t *current = stored;
+#ifdef DYNAMIC_KEYMAP_CACHE
+        uint8_t *cached = dynamic_keymap_cache_range((void *)address, length);
+        if (cached != NULL) {
+            current = cached;
+        } else {
+            eeprom_read_block(stored, (void *)address, length);
+        }
+#else
+        eeprom_read_block(stored, (void *)address, length);
+#endif
+
+        uint16_t first = 0;
+        while (first < length && current[first] == data[first]) {
+            first++;
+        }
+        if (first < length) {
+            uint16_t last = length;
+            while (current[last - 1] == data[last - 1]) {
+                last--;
+            }
+#ifdef DYNAMIC_KEYMAP_CACHE
+            if (cached != NULL) {
+                memcpy(cached + first, data + first, last - first);
+            }
+#endif
+            eeprom_write_block(data + first, (void *)(address + first), last - first);
+        }
+
+        data += length;
+        address += length;
+        size -= length;
+    }
+}
+
+void dynamic_keymap_init(void) {
+#ifdef DYNAMIC_KEYMAP_CACHE
+    dynamic_keymap_cache_load();
+#endif
+    dynamic_keymap_macro_index_build();
+}
+
 uint8_t dynamic_keymap_get_layer_count(void) {
     return DYNAMIC_KEYMAP_LAYER_COUNT;
 }
@@ -145,17 +312,14 @@ uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column)
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) return KC_NO;
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    uint16_t keycode = eeprom_read_byte(address) << 8;
-    keycode |= eeprom_read_byte(address + 1);
-    return keycode;
+    return dynamic_keymap_read_keycode(address);
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) return;
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    dynamic_keymap_write_keycode(address, keycode);
 }
 
 #ifdef ENCODER_MAP_ENABLE
@@ -167,17 +331,14 @@ uint16_t dynamic_keymap_get_encoder(uint8_t layer, uint8_t encoder_id, bool cloc
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || encoder_id >= NUM_ENCODERS) return KC_NO;
     void *address = dynamic_keymap_encoder_to_eeprom_address(layer, encoder_id);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    uint16_t keycode = ((uint16_t)eeprom_read_byte(address + (clockwise ? 0 : 2))) << 8;
-    keycode |= eeprom_read_byte(address + (clockwise ? 0 : 2) + 1);
-    return keycode;
+    return dynamic_keymap_read_keycode(address + (clockwise ? 0 : 2));
 }
 
 void dynamic_keymap_set_encoder(uint8_t layer, uint8_t encoder_id, bool clockwise, uint16_t keycode) {
     if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || encoder_id >= NUM_ENCODERS) return;
     void *address = dynamic_keymap_encoder_to_eeprom_address(layer, encoder_id);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address + (clockwise ? 0 : 2), (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + (clockwise ? 0 : 2) + 1, (uint8_t)(keycode & 0xFF));
+    dynamic_keymap_write_keycode(address + (clockwise ? 0 : 2), keycode);
 }
 #endif // ENCODER_MAP_ENABLE
 
@@ -272,20 +433,46 @@ void dynamic_keymap_reset(void) {
     vial_unlocked = 1;
 #endif
 
-    // Reset the keymaps in EEPROM to what is in flash.
-    for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
-        for (int row = 0; row < MATRIX_ROWS; row++) {
-            for (int column = 0; column < MATRIX_COLS; column++) {
-                dynamic_keymap_set_keycode(layer, row, column, keycode_at_keymap_location_raw(layer, row, column));
-            }
+#ifdef DYNAMIC_KEYMAP_CACHE
+    // compare against what is really in EEPROM, the cache is reloaded once the reset is written
+    dynamic_keymap_cache_valid = false;
+#endif
+
+    // Reset the keymaps in EEPROM to what is in flash, a chunk at a time.
+    uint8_t buffer[DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE];
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_KEYMAP_SIZE; offset += sizeof(buffer)) {
+        uint16_t length = DYNAMIC_KEYMAP_KEYMAP_SIZE - offset;
+        if (length > sizeof(buffer)) {
+            length = sizeof(buffer);
         }
+        for (uint16_t i = 0; i < length; i += 2) {
+            uint16_t index   = (offset + i) / 2;
+            uint8_t  layer   = index / (MATRIX_ROWS * MATRIX_COLS);
+            uint8_t  row     = (index / MATRIX_COLS) % MATRIX_ROWS;
+            uint8_t  column  = index % MATRIX_COLS;
+            uint16_t keycode = keycode_at_keymap_location_raw(layer, row, column);
+            buffer[i]        = (uint8_t)(keycode >> 8);
+            buffer[i + 1]    = (uint8_t)(keycode & 0xFF);
+        }
+        dynamic_keymap_update_block(buffer, DYNAMIC_KEYMAP_EEPROM_ADDR + offset, length);
+    }
+
 #ifdef ENCODER_MAP_ENABLE
+    for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
         for (int encoder = 0; encoder < NUM_ENCODERS; encoder++) {
             dynamic_keymap_set_encoder(layer, encoder, true, keycode_at_encodermap_location_raw(layer, encoder, true));
             dynamic_keymap_set_encoder(layer, encoder, false, keycode_at_encodermap_location_raw(layer, encoder, false));
         }
-#endif // ENCODER_MAP_ENABLE
     }
+#endif // ENCODER_MAP_ENABLE
+
+#ifdef DYNAMIC_KEYMAP_CACHE
+    dynamic_keymap_cache_load();
+#endif
+
+#ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#endif
 
 #ifdef QMK_SETTINGS
     qmk_settings_reset();
@@ -315,28 +502,21 @@ void dynamic_keymap_reset(void) {
 #ifdef VIAL_ENABLE
     /* re-lock the keyboard */
     vial_unlocked = vial_unlocked_prev;
+
+    /* refresh the RAM copies of tap dance, combo and key override entries */
+    vial_init();
 #endif
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
-    }
+    dynamic_keymap_read_block(data, DYNAMIC_KEYMAP_EEPROM_ADDR, offset, size, DYNAMIC_KEYMAP_KEYMAP_SIZE);
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
+#if defined(VIAL_ENABLE) && !defined(VIAL_INSECURE)
+    void *   target                     = (void *)(uintptr_t)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+#endif
 
 #ifdef VIAL_ENABLE
     /* ensure the writes are bounded */
@@ -352,7 +532,7 @@ void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 
         /* initial byte misaligned -- this means the first keycode will be a combination of existing and new data */
         if (offset % 2 != 0) {
-            uint16_t kc = (eeprom_read_byte((uint8_t*)target - 1) << 8) | data[0];
+            uint16_t kc = (dynamic_keymap_read_byte((uint8_t*)target - 1) << 8) | data[0];
             if (kc == QK_BOOT)
                 data[0] = 0xFF;
 
@@ -362,7 +542,7 @@ void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 
         /* final byte misaligned -- this means the last keycode will be a combination of new and existing data */
         if ((offset + size) % 2 != 0) {
-            uint16_t kc = (data[size - 1] << 8) | eeprom_read_byte((uint8_t*)target + size);
+            uint16_t kc = (data[size - 1] << 8) | dynamic_keymap_read_byte((uint8_t*)target + size);
             if (kc == QK_BOOT)
                 data[size - 1] = 0xFF;
 
@@ -382,13 +562,16 @@ void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 #endif
 #endif
 
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
+    if (offset < dynamic_keymap_eeprom_size) {
+        if (size > dynamic_keymap_eeprom_size - offset) {
+            size = dynamic_keymap_eeprom_size - offset;
         }
-        source++;
-        target++;
+        dynamic_keymap_update_block(data, DYNAMIC_KEYMAP_EEPROM_ADDR + offset, size);
     }
+
+#ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#endif
 }
 
 uint16_t keycode_at_keymap_location(uint8_t layer_num, uint8_t row, uint8_t column) {
@@ -416,135 +599,224 @@ uint16_t dynamic_keymap_macro_get_buffer_size(void) {
 }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *target = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
-    }
+    dynamic_keymap_read_block(data, DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR, offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    if (offset >= DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
+        return;
+    }
+    if (size > DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset) {
+        size = DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset;
     }
+    dynamic_keymap_update_block(data, DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset, size);
+
+    // Uploads span many packets, so only rebuild the index once it is needed.
+    macro_index_dirty = true;
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    uint8_t zeros[DYNAMIC_KEYMAP_EEPROM_CHUNK_SIZE] = {0};
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; offset += sizeof(zeros)) {
+        uint16_t length = DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset;
+        if (length > sizeof(zeros)) {
+            length = sizeof(zeros);
+        }
+        dynamic_keymap_update_block(zeros, DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset, length);
     }
+    macro_index_dirty = true;
 }
 
-static uint16_t decode_keycode(uint16_t kc) {
-    /* map 0xFF01 => 0x0100; 0xFF02 => 0x0200, etc */
-    if (kc > 0xFF00)
-        return (kc & 0xFF) << 8;
-    return kc;
+static void dynamic_keymap_macro_reader_init(dynamic_keymap_macro_reader_t *reader, uint16_t offset) {
+    reader->offset   = offset;
+    reader->length   = 0;
+    reader->position = 0;
 }
 
-void dynamic_keymap_macro_send(uint8_t id) {
-    if (id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
-        return;
+static uint8_t dynamic_keymap_macro_reader_next(dynamic_keymap_macro_reader_t *reader) {
+    if (reader->position >= reader->length) {
+        reader->offset += reader->length;
+        reader->position = 0;
+        reader->length   = 0;
+        if (reader->offset >= DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
+            return 0;
+        }
+        uint16_t remaining = DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - reader->offset;
+        reader->length     = remaining < sizeof(reader->buffer) ? remaining : sizeof(reader->buffer);
+        eeprom_read_block(reader->buffer, (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + reader->offset), reader->length);
+    }
+    return reader->buffer[reader->position++];
+}
+
+static void dynamic_keymap_macro_index_build(void) {
+    for (uint8_t id = 0; id < DYNAMIC_KEYMAP_MACRO_COUNT; id++) {
+        macro_index[id] = DYNAMIC_KEYMAP_MACRO_INVALID;
     }
+    macro_index_dirty = false;
 
     // Check the last byte of the buffer.
     // If it's not zero, then we are in the middle
     // of buffer writing, possibly an aborted buffer
-    // write. So do nothing.
+    // write. So no macro is usable.
     void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
     if (eeprom_read_byte(p) != 0) {
         return;
     }
 
-    // Skip N null characters
-    // p will then point to the Nth macro
-    p         = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (id > 0) {
-        // If we are past the end of the buffer, then the buffer
-        // contents are garbage, i.e. there were not DYNAMIC_KEYMAP_MACRO_COUNT
-        // nulls in the buffer.
-        if (p == end) {
-            return;
-        }
-        if (eeprom_read_byte(p) == 0) {
-            --id;
+    // Macro N starts after the Nth null character. If there are not
+    // DYNAMIC_KEYMAP_MACRO_COUNT nulls in the buffer, the remaining
+    // macros are left invalid.
+    dynamic_keymap_macro_reader_t reader;
+    dynamic_keymap_macro_reader_init(&reader, 0);
+    uint8_t id      = 0;
+    macro_index[id] = 0;
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1; offset++) {
+        if (dynamic_keymap_macro_reader_next(&reader) == 0) {
+            if (++id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
+                break;
+            }
+            macro_index[id] = offset + 1;
         }
-        ++p;
     }
+}
 
+static uint16_t decode_keycode(uint16_t kc) {
+    /* map 0xFF01 => 0x0100; 0xFF02 => 0x0200, etc */
+    if (kc > 0xFF00)
+        return (kc & 0xFF) << 8;
+    return kc;
+}
+
+// Plays the next element of a macro, returning false once the end of the macro
+// has been reached. The time to wait before the next element is stored in delay.
+static bool dynamic_keymap_macro_step(dynamic_keymap_macro_reader_t *reader, uint16_t *delay) {
     // Send the macro string one or three chars at a time
     // by making temporary 1 or 3 char strings
     char data[4] = {0, 0, 0, 0};
-    // We already checked there was a null at the end of
-    // the buffer, so this cannot go past the end
-    while (1) {
-        data[0] = eeprom_read_byte(p++);
-        data[1] = 0;
-        // Stop at the null terminator of this macro string
-        if (data[0] == 0) {
-            break;
-        }
-        if (data[0] == SS_QMK_PREFIX) {
-            // If the char is magic, process it as indicated by the next character
-            // (tap, down, up, delay)
-            data[1] = eeprom_read_byte(p++);
-            if (data[1] == 0)
-                break;
-            if (data[1] == SS_TAP_CODE || data[1] == SS_DOWN_CODE || data[1] == SS_UP_CODE) {
-                // For tap, down, up, just stuff it into the array and send_string it
-                data[2] = eeprom_read_byte(p++);
-                if (data[2] != 0)
-                    send_string(data);
-            } else if (data[1] == VIAL_MACRO_EXT_TAP || data[1] == VIAL_MACRO_EXT_DOWN || data[1] == VIAL_MACRO_EXT_UP) {
-                data[2] = eeprom_read_byte(p++);
-                if (data[2] != 0) {
-                    data[3] = eeprom_read_byte(p++);
-                    if (data[3] != 0) {
-                        uint16_t kc;
-                        memcpy(&kc, &data[2], sizeof(kc));
-                        kc = decode_keycode(kc);
-                        switch (data[1]) {
-                        case VIAL_MACRO_EXT_TAP:
-                            vial_keycode_tap(kc);
-                            break;
-                        case VIAL_MACRO_EXT_DOWN:
-                            vial_keycode_down(kc);
-                            break;
-                        case VIAL_MACRO_EXT_UP:
-                            vial_keycode_up(kc);
-                            break;
-                        }
+
+    *delay  = 0;
+    data[0] = dynamic_keymap_macro_reader_next(reader);
+    // Stop at the null terminator of this macro string
+    if (data[0] == 0) {
+        return false;
+    }
+    if (data[0] == SS_QMK_PREFIX) {
+        // If the char is magic, process it as indicated by the next character
+        // (tap, down, up, delay)
+        data[1] = dynamic_keymap_macro_reader_next(reader);
+        if (data[1] == 0)
+            return false;
+        if (data[1] == SS_TAP_CODE || data[1] == SS_DOWN_CODE || data[1] == SS_UP_CODE) {
+            // For tap, down, up, just stuff it into the array and send_string it
+            data[2] = dynamic_keymap_macro_reader_next(reader);
+            if (data[2] != 0)
+                send_string(data);
+        } else if (data[1] == VIAL_MACRO_EXT_TAP || data[1] == VIAL_MACRO_EXT_DOWN || data[1] == VIAL_MACRO_EXT_UP) {
+            data[2] = dynamic_keymap_macro_reader_next(reader);
+            if (data[2] != 0) {
+                data[3] = dynamic_keymap_macro_reader_next(reader);
+                if (data[3] != 0) {
+                    uint16_t kc;
+                    memcpy(&kc, &data[2], sizeof(kc));
+                    kc = decode_keycode(kc);
+                    switch (data[1]) {
+                    case VIAL_MACRO_EXT_TAP:
+                        vial_keycode_tap(kc);
+                        break;
+                    case VIAL_MACRO_EXT_DOWN:
+                        vial_keycode_down(kc);
+                        break;
+                    case VIAL_MACRO_EXT_UP:
+                        vial_keycode_up(kc);
+                        break;
                     }
                 }
-            } else if (data[1] == SS_DELAY_CODE) {
-                // For delay, decode the delay and wait_ms for that amount
-                uint8_t d0 = eeprom_read_byte(p++);
-                uint8_t d1 = eeprom_read_byte(p++);
-                if (d0 == 0 || d1 == 0)
-                    break;
-                // we cannot use 0 for these, need to subtract 1 and use 255 instead of 256 for delay calculation
-                int ms = (d0 - 1) + (d1 - 1) * 255;
-                while (ms--) wait_ms(1);
             }
-        } else {
-            // If the char wasn't magic, just send it
-            send_string_with_delay(data, DYNAMIC_KEYMAP_MACRO_DELAY);
+        } else if (data[1] == SS_DELAY_CODE) {
+            // For delay, decode the delay and wait for that amount
+            uint8_t d0 = dynamic_keymap_macro_reader_next(reader);
+            uint8_t d1 = dynamic_keymap_macro_reader_next(reader);
+            if (d0 == 0 || d1 == 0)
+                return false;
+            // we cannot use 0 for these, need to subtract 1 and use 255 instead of 256 for delay calculation
+            *delay = (d0 - 1) + (d1 - 1) * 255;
         }
+    } else {
+        // If the char wasn't magic, just send it
+        send_string(data);
+        *delay = DYNAMIC_KEYMAP_MACRO_DELAY;
+    }
+    return true;
+}
+
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+static struct {
+    dynamic_keymap_macro_reader_t reader;
+    uint32_t                      timer;
+    uint16_t                      delay;
+    bool                          active;
+    bool                          stepping;
+} macro_player;
+
+void dynamic_keymap_macro_task(void) {
+    if (!macro_player.active || timer_elapsed32(macro_player.timer) < macro_player.delay) {
+        return;
+    }
+
+    // Keys sent by the macro may be processed as regular key events, which must
+    // neither cancel nor restart the macro.
+    macro_player.stepping = true;
+    macro_player.active   = dynamic_keymap_macro_step(&macro_player.reader, &macro_player.delay);
+    macro_player.stepping = false;
+    macro_player.timer    = timer_read32();
+}
+
+bool dynamic_keymap_macro_is_playing(void) {
+    return macro_player.active;
+}
+
+bool dynamic_keymap_macro_cancel(void) {
+    if (!macro_player.active || macro_player.stepping) {
+        return false;
     }
+    macro_player.active = false;
+    // Release anything the macro was holding down
+    clear_keyboard();
+    return true;
+}
+#endif
+
+void dynamic_keymap_macro_send(uint8_t id) {
+    if (id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
+        return;
+    }
+
+    if (macro_index_dirty) {
+        dynamic_keymap_macro_index_build();
+    }
+    if (macro_index[id] == DYNAMIC_KEYMAP_MACRO_INVALID) {
+        return;
+    }
+
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+    // Macros started from within a macro are not supported, the player only
+    // keeps track of one at a time.
+    if (macro_player.stepping) {
+        return;
+    }
+    dynamic_keymap_macro_reader_init(&macro_player.reader, macro_index[id]);
+    macro_player.active = true;
+    macro_player.delay  = 0;
+    dynamic_keymap_macro_task();
+#else
+    dynamic_keymap_macro_reader_t reader;
+    dynamic_keymap_macro_reader_init(&reader, macro_index[id]);
+
+    // The index is only valid if there is a null at the end
+    // of the buffer, so this cannot go past the end
+    uint16_t delay;
+    while (dynamic_keymap_macro_step(&reader, &delay)) {
+        while (delay--) wait_ms(1);
+    }
+#endif
 }
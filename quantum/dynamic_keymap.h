@@ -30,6 +30,12 @@
 #    define DYNAMIC_KEYMAP_MACRO_COUNT 16
 #endif
 
+void     dynamic_keymap_init(void);
+#ifdef DYNAMIC_KEYMAP_CACHE
+// Reloads the RAM copy of the keymap from EEPROM, e.g. after it was modified
+// without going through dynamic_keymap_set_*()
+void dynamic_keymap_cache_load(void);
+#endif
 uint8_t  dynamic_keymap_get_layer_count(void);
 void *   dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column);
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column);
@@ -96,3 +102,13 @@ void     dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t
 void     dynamic_keymap_macro_reset(void);
 
 void dynamic_keymap_macro_send(uint8_t id);
+
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+// With DYNAMIC_KEYMAP_MACRO_ASYNC, dynamic_keymap_macro_send() only starts the
+// macro and the rest is played back from dynamic_keymap_macro_task(), so that
+// delays inside the macro do not stall the keyboard.
+void dynamic_keymap_macro_task(void);
+bool dynamic_keymap_macro_is_playing(void);
+// Stops the running macro and releases all keys, returns false if none was running.
+bool dynamic_keymap_macro_cancel(void);
+#endif
@@ -0,0 +1,39 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <iostream>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "dynamic_keymap_mock.h"
+#include "keymap_introspection.h"
+}
+
+// Prints the cost of a keymap lookup on the host, with and without DYNAMIC_KEYMAP_CACHE
+TEST(DynamicKeymapBenchmark, Lookup) {
+    dynamic_keymap_reset();
+    dynamic_keymap_init();
+    mock_eeprom_reset_counters();
+
+    const uint32_t iterations = 1000;
+    uint32_t       lookups    = 0;
+    uint32_t       checksum   = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; ++layer) {
+            for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+                for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+                    checksum += keycode_at_keymap_location(layer, row, col);
+                    ++lookups;
+                }
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_NE(checksum, 0);
+    std::cout << "[  BENCH   ] " << lookups << " lookups, " << mock_eeprom_reads << " EEPROM reads, " << (double)elapsed / lookups << " ns/lookup" << std::endl;
+}
@@ -0,0 +1,70 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "dynamic_keymap_mock.h"
+#include "eeprom.h"
+#include "keycodes.h"
+
+uint8_t  mock_eeprom[EEPROM_SIZE];
+uint32_t mock_eeprom_reads  = 0;
+uint32_t mock_eeprom_writes = 0;
+char     mock_sent_string[256];
+
+void mock_eeprom_reset_counters(void) {
+    mock_eeprom_reads  = 0;
+    mock_eeprom_writes = 0;
+}
+
+uint16_t mock_keymap_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+    return KC_A + ((layer + row * MATRIX_COLS + column) % (KC_Z - KC_A + 1));
+}
+
+uint16_t keycode_at_keymap_location_raw(uint8_t layer_num, uint8_t row, uint8_t column) {
+    return mock_keymap_keycode(layer_num, row, column);
+}
+
+// Each call counts as one bus transaction, as it would on an I2C/SPI EEPROM.
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+    ++mock_eeprom_reads;
+    return mock_eeprom[(uintptr_t)addr];
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    ++mock_eeprom_reads;
+    memcpy(buf, &mock_eeprom[(uintptr_t)addr], len);
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value) {
+    if (mock_eeprom[(uintptr_t)addr] != value) {
+        ++mock_eeprom_writes;
+        mock_eeprom[(uintptr_t)addr] = value;
+    }
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    ++mock_eeprom_writes;
+    memcpy(&mock_eeprom[(uintptr_t)addr], buf, len);
+}
+
+void eeprom_update_block(const void *buf, void *addr, size_t len) {
+    if (memcmp(&mock_eeprom[(uintptr_t)addr], buf, len) != 0) {
+        eeprom_write_block(buf, addr, len);
+    }
+}
+
+void mock_sent_string_clear(void) {
+    mock_sent_string[0] = 0;
+}
+
+void send_string(const char *string) {
+    strncat(mock_sent_string, string, sizeof(mock_sent_string) - strlen(mock_sent_string) - 1);
+}
+
+void clear_keyboard(void) {
+    strncat(mock_sent_string, "<clear>", sizeof(mock_sent_string) - strlen(mock_sent_string) - 1);
+}
+
+void send_string_with_delay(const char *string, uint8_t interval) {
+    send_string(string);
+}
@@ -0,0 +1,17 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+extern uint8_t  mock_eeprom[];
+extern uint32_t mock_eeprom_reads;
+extern uint32_t mock_eeprom_writes;
+extern char     mock_sent_string[];
+extern uint8_t  mock_raw_hid_reports[][32];
+extern uint16_t mock_raw_hid_report_count;
+
+void     mock_eeprom_reset_counters(void);
+void     mock_sent_string_clear(void);
+uint16_t mock_keymap_keycode(uint8_t layer, uint8_t row, uint8_t column);
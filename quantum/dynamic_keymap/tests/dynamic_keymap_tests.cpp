@@ -0,0 +1,248 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "dynamic_keymap_mock.h"
+#include "keymap_introspection.h"
+#include "keycodes.h"
+#include "send_string_keycodes.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+static void play_macro(uint8_t id) {
+    dynamic_keymap_macro_send(id);
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+    while (dynamic_keymap_macro_is_playing()) {
+        advance_time(1);
+        dynamic_keymap_macro_task();
+    }
+#endif
+}
+
+class DynamicKeymap : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dynamic_keymap_reset();
+        dynamic_keymap_init();
+        mock_eeprom_reset_counters();
+    }
+};
+
+TEST_F(DynamicKeymap, ResetLoadsKeymapFromFlash) {
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; ++layer) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+            for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+                EXPECT_EQ(dynamic_keymap_get_keycode(layer, row, col), mock_keymap_keycode(layer, row, col));
+            }
+        }
+    }
+}
+
+TEST_F(DynamicKeymap, ResetWritesOverErasedEeprom) {
+    // Blank or invalid EEPROM is reset before the cache ever saw its contents
+    memset(mock_eeprom, 0xFF, EEPROM_SIZE);
+    dynamic_keymap_reset();
+
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; ++layer) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+            for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+                uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(layer, row, col);
+                uint16_t stored  = (mock_eeprom[(uintptr_t)address] << 8) | mock_eeprom[(uintptr_t)address + 1];
+                EXPECT_EQ(stored, mock_keymap_keycode(layer, row, col));
+                EXPECT_EQ(dynamic_keymap_get_keycode(layer, row, col), mock_keymap_keycode(layer, row, col));
+            }
+        }
+    }
+}
+
+TEST_F(DynamicKeymap, SetKeycodeWritesThroughToEeprom) {
+    dynamic_keymap_set_keycode(2, 3, 4, QK_BOOT);
+    EXPECT_EQ(dynamic_keymap_get_keycode(2, 3, 4), QK_BOOT);
+
+    uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(2, 3, 4);
+    EXPECT_EQ(mock_eeprom[(uintptr_t)address], QK_BOOT >> 8);
+    EXPECT_EQ(mock_eeprom[(uintptr_t)address + 1], QK_BOOT & 0xFF);
+}
+
+TEST_F(DynamicKeymap, SetBufferWritesThroughToEeprom) {
+    // Unaligned write spanning the end of one keycode and the start of the next
+    uint8_t  data[3] = {0x12, 0x34, 0x56};
+    uint16_t offset  = MATRIX_COLS * 2 + 1;
+    dynamic_keymap_set_buffer(offset, sizeof(data), data);
+
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 1, 0), (mock_keymap_keycode(0, 1, 0) & 0xFF00) | 0x12);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 1, 1), 0x3456);
+
+    uint8_t readback[3];
+    dynamic_keymap_get_buffer(offset, sizeof(readback), readback);
+    EXPECT_EQ(memcmp(readback, data, sizeof(data)), 0);
+
+    // Reloading from EEPROM must not change anything
+    dynamic_keymap_init();
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 1, 1), 0x3456);
+}
+
+TEST_F(DynamicKeymap, BufferSyncUsesBlockTransfers) {
+    // Read the whole keymap the way VIA does, 28 bytes per packet
+    const uint16_t size    = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
+    const uint16_t packet  = 28;
+    uint16_t       packets = 0;
+    uint8_t        keymap[size];
+    for (uint16_t offset = 0; offset < size; offset += packet) {
+        dynamic_keymap_get_buffer(offset, size - offset < packet ? size - offset : packet, &keymap[offset]);
+        ++packets;
+    }
+#ifdef DYNAMIC_KEYMAP_CACHE
+    EXPECT_EQ(mock_eeprom_reads, 0);
+#else
+    EXPECT_EQ(mock_eeprom_reads, packets);
+#endif
+
+    // Writing back identical data must not touch EEPROM
+    for (uint16_t offset = 0; offset < size; offset += packet) {
+        dynamic_keymap_set_buffer(offset, size - offset < packet ? size - offset : packet, &keymap[offset]);
+    }
+    EXPECT_EQ(mock_eeprom_writes, 0);
+
+    // A single changed keycode results in a single, minimal write
+    mock_eeprom_reset_counters();
+    uint16_t index     = (1 * MATRIX_ROWS * MATRIX_COLS + 2 * MATRIX_COLS + 3) * 2;
+    keymap[index]      = QK_BOOT >> 8;
+    keymap[index + 1]  = QK_BOOT & 0xFF;
+    dynamic_keymap_set_buffer(0, size, keymap);
+    EXPECT_EQ(mock_eeprom_writes, 1);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 2, 3), QK_BOOT);
+
+    // Past the end of the keymap reads back as zero
+    uint8_t tail[4] = {0xAA, 0xAA, 0xAA, 0xAA};
+    dynamic_keymap_get_buffer(size - 2, sizeof(tail), tail);
+    EXPECT_EQ(tail[2], 0);
+    EXPECT_EQ(tail[3], 0);
+}
+
+TEST_F(DynamicKeymap, MacroBufferUsesBlockTransfers) {
+    dynamic_keymap_macro_reset();
+    mock_eeprom_reset_counters();
+
+    // Resetting an already empty buffer writes nothing
+    dynamic_keymap_macro_reset();
+    EXPECT_EQ(mock_eeprom_writes, 0);
+
+    uint8_t macro[] = {'a', 'b', 0, 'c', 0};
+    dynamic_keymap_macro_set_buffer(10, sizeof(macro), macro);
+    EXPECT_EQ(mock_eeprom_writes, 1);
+
+    mock_eeprom_reset_counters();
+    uint8_t readback[sizeof(macro)];
+    dynamic_keymap_macro_get_buffer(10, sizeof(readback), readback);
+    EXPECT_EQ(mock_eeprom_reads, 1);
+    EXPECT_EQ(memcmp(readback, macro, sizeof(macro)), 0);
+
+    // Writes beyond the end of the macro area are dropped
+    uint16_t end = dynamic_keymap_macro_get_buffer_size();
+    mock_eeprom_reset_counters();
+    dynamic_keymap_macro_set_buffer(end, sizeof(macro), macro);
+    EXPECT_EQ(mock_eeprom_writes, 0);
+
+    dynamic_keymap_macro_reset();
+    dynamic_keymap_macro_get_buffer(10, sizeof(readback), readback);
+    EXPECT_EQ(readback[0], 0);
+    EXPECT_EQ(readback[1], 0);
+}
+
+TEST_F(DynamicKeymap, MacroSendUsesIndex) {
+    uint8_t macros[] = {'a', 'b', 0, 'c', 0, 'x', 'y', 'z', 0};
+    dynamic_keymap_macro_reset();
+    dynamic_keymap_macro_set_buffer(0, sizeof(macros), macros);
+
+    mock_sent_string_clear();
+    play_macro(2);
+    EXPECT_STREQ(mock_sent_string, "xyz");
+
+    // Once indexed, a macro is fetched with a single block read
+    mock_sent_string_clear();
+    mock_eeprom_reset_counters();
+    play_macro(1);
+    EXPECT_STREQ(mock_sent_string, "c");
+    EXPECT_EQ(mock_eeprom_reads, 1);
+
+    // An unterminated buffer disables all macros
+    uint16_t end  = dynamic_keymap_macro_get_buffer_size();
+    uint8_t  junk = 'q';
+    dynamic_keymap_macro_set_buffer(end - 1, 1, &junk);
+    mock_sent_string_clear();
+    play_macro(0);
+    EXPECT_STREQ(mock_sent_string, "");
+}
+
+TEST_F(DynamicKeymap, MacroSendHonoursDelays) {
+    // "a", 1000ms delay, "b"
+    uint8_t macros[] = {'a', SS_QMK_PREFIX, SS_DELAY_CODE, 1 + 235, 1 + 3, 'b', 0};
+    dynamic_keymap_macro_reset();
+    dynamic_keymap_macro_set_buffer(0, sizeof(macros), macros);
+
+    set_time(0);
+    mock_sent_string_clear();
+    dynamic_keymap_macro_send(0);
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+    // Playback continues in the background
+    EXPECT_STREQ(mock_sent_string, "a");
+    EXPECT_TRUE(dynamic_keymap_macro_is_playing());
+    dynamic_keymap_macro_task();
+    advance_time(999);
+    dynamic_keymap_macro_task();
+    EXPECT_STREQ(mock_sent_string, "a");
+    advance_time(1);
+    dynamic_keymap_macro_task();
+    EXPECT_STREQ(mock_sent_string, "ab");
+    dynamic_keymap_macro_task();
+    EXPECT_FALSE(dynamic_keymap_macro_is_playing());
+    EXPECT_FALSE(dynamic_keymap_macro_cancel());
+#else
+    EXPECT_STREQ(mock_sent_string, "ab");
+    EXPECT_GE(timer_read32(), 1000);
+#endif
+}
+
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+TEST_F(DynamicKeymap, MacroCanBeCancelled) {
+    uint8_t macros[] = {'a', SS_QMK_PREFIX, SS_DELAY_CODE, 1 + 100, 1, 'b', 0};
+    dynamic_keymap_macro_reset();
+    dynamic_keymap_macro_set_buffer(0, sizeof(macros), macros);
+
+    set_time(0);
+    mock_sent_string_clear();
+    dynamic_keymap_macro_send(0);
+    dynamic_keymap_macro_task();
+    EXPECT_TRUE(dynamic_keymap_macro_cancel());
+    EXPECT_FALSE(dynamic_keymap_macro_is_playing());
+
+    advance_time(1000);
+    dynamic_keymap_macro_task();
+    EXPECT_STREQ(mock_sent_string, "a<clear>");
+}
+#endif
+
+TEST_F(DynamicKeymap, LookupsOnlyReadEepromWithoutCache) {
+    uint32_t lookups = 0;
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; ++layer) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+            for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+                EXPECT_EQ(keycode_at_keymap_location(layer, row, col), mock_keymap_keycode(layer, row, col));
+                ++lookups;
+            }
+        }
+    }
+#ifdef DYNAMIC_KEYMAP_CACHE
+    EXPECT_EQ(mock_eeprom_reads, 0);
+#else
+    EXPECT_EQ(mock_eeprom_reads, lookups * 2);
+#endif
+}
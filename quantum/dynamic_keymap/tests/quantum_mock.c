@@ -0,0 +1,27 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "quantum.h"
+#include "process_tap_dance.h"
+#include "raw_hid.h"
+#include "dynamic_keymap_mock.h"
+
+#define MOCK_RAW_HID_MAX_REPORTS 16
+
+uint8_t  mock_raw_hid_reports[MOCK_RAW_HID_MAX_REPORTS][32];
+uint16_t mock_raw_hid_report_count;
+
+void register_code16(uint16_t code) {}
+void unregister_code16(uint16_t code) {}
+void action_exec(keyevent_t event) {}
+bool matrix_is_on(uint8_t row, uint8_t col) {
+    return false;
+}
+void process_tap_dance_action_on_dance_finished(tap_dance_action_t *action) {}
+
+void raw_hid_send(uint8_t *data, uint8_t length) {
+    if (mock_raw_hid_report_count < MOCK_RAW_HID_MAX_REPORTS && length == 32) {
+        memcpy(mock_raw_hid_reports[mock_raw_hid_report_count], data, length);
+    }
+    mock_raw_hid_report_count++;
+}
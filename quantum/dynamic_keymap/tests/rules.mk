@@ -0,0 +1,104 @@
+dynamic_keymap_DEFS := \
+	-DMATRIX_ROWS=6 \
+	-DMATRIX_COLS=18 \
+	-DDYNAMIC_KEYMAP_ENABLE \
+	-DDYNAMIC_KEYMAP_LAYER_COUNT=8 \
+	-DVIAL_ENABLE \
+	-DVIAL_INSECURE \
+	-DEEPROM_CUSTOM \
+	-DEEPROM_SIZE=4096 \
+	-DTAP_CODE_DELAY=0 \
+	-DNO_DEBUG
+
+dynamic_keymap_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/vial_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_tests.cpp \
+	$(QUANTUM_PATH)/dynamic_keymap.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+dynamic_keymap_cache_DEFS := \
+	$(dynamic_keymap_DEFS) \
+	-DDYNAMIC_KEYMAP_CACHE
+
+dynamic_keymap_cache_SRC := \
+	$(dynamic_keymap_SRC)
+
+dynamic_keymap_macro_async_DEFS := \
+	$(dynamic_keymap_DEFS) \
+	-DDYNAMIC_KEYMAP_MACRO_ASYNC
+
+dynamic_keymap_macro_async_SRC := \
+	$(dynamic_keymap_SRC)
+
+vial_tap_dance_DEFS := \
+	$(dynamic_keymap_DEFS) \
+	-DNO_PRINT \
+	-DTAP_DANCE_ENABLE \
+	-DTAPPING_TERM=200 \
+	-DTAPPING_TERM_PER_KEY \
+	-DVIAL_TAP_DANCE_ENTRIES=8 \
+	'-DVIAL_KEYBOARD_UID={0,0,0,0,0,0,0,0}'
+
+vial_tap_dance_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/quantum_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/vial_tap_dance_tests.cpp \
+	$(QUANTUM_PATH)/dynamic_keymap.c \
+	$(QUANTUM_PATH)/vial.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+vial_tap_dance_INC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests
+
+vial_definition_DEFS := \
+	$(vial_tap_dance_DEFS) \
+	-DVIAL_DEF_STREAM_ENABLE
+
+vial_definition_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/quantum_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/vial_definition_tests.cpp \
+	$(QUANTUM_PATH)/dynamic_keymap.c \
+	$(QUANTUM_PATH)/vial.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+vial_definition_INC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests
+
+vialrgb_DEFS := \
+	-DMATRIX_ROWS=2 \
+	-DMATRIX_COLS=4 \
+	-DEEPROM_CUSTOM \
+	-DEEPROM_SIZE=4096 \
+	-DRGB_MATRIX_ENABLE \
+	-DRGB_MATRIX_LED_COUNT=8 \
+	-DVIALRGB_ENABLE \
+	-DVIALRGB_DIRECT_STREAM
+
+vialrgb_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/vialrgb_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/vialrgb_tests.cpp \
+	$(QUANTUM_PATH)/vialrgb.c
+
+vialrgb_INC := \
+	$(QUANTUM_PATH)/rgb_matrix \
+	$(QUANTUM_PATH)/rgb_matrix/animations \
+	$(QUANTUM_PATH)/rgb_matrix/animations/runners
+
+dynamic_keymap_benchmark_DEFS := \
+	$(dynamic_keymap_DEFS)
+
+dynamic_keymap_benchmark_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/vial_mock.c \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_benchmark.cpp \
+	$(QUANTUM_PATH)/dynamic_keymap.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+dynamic_keymap_cache_benchmark_DEFS := \
+	$(dynamic_keymap_DEFS) \
+	-DDYNAMIC_KEYMAP_CACHE
+
+dynamic_keymap_cache_benchmark_SRC := \
+	$(dynamic_keymap_benchmark_SRC)
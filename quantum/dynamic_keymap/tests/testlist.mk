@@ -0,0 +1,6 @@
+TEST_LIST += dynamic_keymap dynamic_keymap_cache dynamic_keymap_macro_async vial_tap_dance vial_definition vialrgb
+
+# Timing only, run with `make test:dynamic_keymap_benchmark BENCHMARK=yes`
+ifeq ($(strip $(BENCHMARK)), yes)
+    TEST_LIST += dynamic_keymap_benchmark dynamic_keymap_cache_benchmark
+endif
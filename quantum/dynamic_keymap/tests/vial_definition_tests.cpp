@@ -0,0 +1,149 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+// vial.h checks its entry layouts with C11 _Static_assert
+#define _Static_assert static_assert
+
+extern "C" {
+#include "dynamic_keymap_mock.h"
+#include "progmem.h"
+#include "vial.h"
+#include "vial_generated_keyboard_definition.h"
+
+void advance_time(uint32_t ms);
+}
+
+#include <vector>
+
+static uint32_t crc32(const std::vector<uint8_t> &data) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint8_t byte : data) {
+        crc ^= byte;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+class VialDefinition : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        mock_raw_hid_report_count = 0;
+    }
+
+    void start_stream(uint32_t start, uint16_t count, uint8_t *msg) {
+        memset(msg, 0, VIAL_RAW_EPSIZE);
+        msg[0] = 0xFE;
+        msg[1] = vial_get_def_stream;
+        msg[2] = start & 0xFF;
+        msg[3] = (start >> 8) & 0xFF;
+        msg[4] = (start >> 16) & 0xFF;
+        msg[5] = (start >> 24) & 0xFF;
+        msg[6] = count & 0xFF;
+        msg[7] = (count >> 8) & 0xFF;
+        vial_handle_cmd(msg, VIAL_RAW_EPSIZE);
+    }
+
+    void run_stream(void) {
+        for (int i = 0; i < 100; ++i) {
+            advance_time(1);
+            vial_task();
+        }
+    }
+};
+
+TEST_F(VialDefinition, StreamHeaderDescribesTransfer) {
+    uint8_t msg[VIAL_RAW_EPSIZE];
+    start_stream(0, 0, msg);
+
+    EXPECT_EQ(read_u32(&msg[0]), sizeof(keyboard_definition));
+    EXPECT_EQ(read_u32(&msg[4]), VIAL_KEYBOARD_DEFINITION_CRC32);
+    EXPECT_EQ(read_u32(&msg[8]), 0u);
+    EXPECT_EQ(msg[12] | (msg[13] << 8), (sizeof(keyboard_definition) + VIAL_RAW_EPSIZE - 3) / (VIAL_RAW_EPSIZE - 2));
+}
+
+TEST_F(VialDefinition, StreamsWholeDefinition) {
+    uint8_t msg[VIAL_RAW_EPSIZE];
+    start_stream(0, 0, msg);
+    uint16_t count = msg[12] | (msg[13] << 8);
+
+    run_stream();
+    ASSERT_EQ(mock_raw_hid_report_count, count);
+
+    std::vector<uint8_t> blob;
+    for (uint16_t i = 0; i < count; ++i) {
+        EXPECT_EQ(mock_raw_hid_reports[i][0] | (mock_raw_hid_reports[i][1] << 8), i);
+        blob.insert(blob.end(), &mock_raw_hid_reports[i][2], &mock_raw_hid_reports[i][VIAL_RAW_EPSIZE]);
+    }
+    blob.resize(sizeof(keyboard_definition));
+    EXPECT_EQ(0, memcmp(blob.data(), keyboard_definition, sizeof(keyboard_definition)));
+    EXPECT_EQ(crc32(blob), read_u32(&msg[4]));
+}
+
+TEST_F(VialDefinition, StreamIsPacedToOneReportPerMillisecond) {
+    uint8_t msg[VIAL_RAW_EPSIZE];
+    start_stream(0, 0, msg);
+
+    for (int i = 0; i < 10; ++i) {
+        vial_task();
+    }
+    EXPECT_EQ(mock_raw_hid_report_count, 0);
+
+    advance_time(1);
+    for (int i = 0; i < 10; ++i) {
+        vial_task();
+    }
+    EXPECT_EQ(mock_raw_hid_report_count, 1);
+}
+
+TEST_F(VialDefinition, FlushSendsRestOfStreamBeforeNextReply) {
+    uint8_t msg[VIAL_RAW_EPSIZE];
+    start_stream(0, 0, msg);
+    uint16_t count = msg[12] | (msg[13] << 8);
+
+    advance_time(1);
+    vial_task();
+    ASSERT_EQ(mock_raw_hid_report_count, 1);
+
+    vial_def_stream_flush();
+    ASSERT_EQ(mock_raw_hid_report_count, count);
+    for (uint16_t i = 0; i < count; ++i) {
+        EXPECT_EQ(mock_raw_hid_reports[i][0] | (mock_raw_hid_reports[i][1] << 8), i);
+    }
+
+    run_stream();
+    EXPECT_EQ(mock_raw_hid_report_count, count);
+}
+
+TEST_F(VialDefinition, StreamResumesFromOffset) {
+    uint8_t msg[VIAL_RAW_EPSIZE];
+    start_stream(45, 1, msg);
+    EXPECT_EQ(read_u32(&msg[8]), 45u);
+    EXPECT_EQ(msg[12] | (msg[13] << 8), 1);
+
+    run_stream();
+    ASSERT_EQ(mock_raw_hid_report_count, 1);
+    EXPECT_EQ(0, memcmp(&mock_raw_hid_reports[0][2], &keyboard_definition[45], VIAL_RAW_EPSIZE - 2));
+}
+
+TEST_F(VialDefinition, StreamPastEndIsEmpty) {
+    uint8_t msg[VIAL_RAW_EPSIZE];
+    start_stream(sizeof(keyboard_definition), 0, msg);
+    EXPECT_EQ(msg[12] | (msg[13] << 8), 0);
+
+    run_stream();
+    EXPECT_EQ(mock_raw_hid_report_count, 0);
+}
+
+TEST_F(VialDefinition, PagedDownloadStillWorks) {
+    uint8_t msg[VIAL_RAW_EPSIZE] = {0xFE, vial_get_def, 1, 0};
+    vial_handle_cmd(msg, sizeof(msg));
+    EXPECT_EQ(0, memcmp(msg, &keyboard_definition[VIAL_RAW_EPSIZE], VIAL_RAW_EPSIZE));
+}
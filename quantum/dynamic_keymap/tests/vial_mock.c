@@ -0,0 +1,11 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "vial.h"
+
+int vial_unlocked = 1;
+
+void vial_init(void) {}
+void vial_keycode_down(uint16_t keycode) {}
+void vial_keycode_up(uint16_t keycode) {}
+void vial_keycode_tap(uint16_t keycode) {}
@@ -0,0 +1,71 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+// vial.h checks its entry layouts with C11 _Static_assert
+#define _Static_assert static_assert
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "dynamic_keymap_mock.h"
+#include "action_tapping.h"
+#include "process_tap_dance.h"
+#include "vial.h"
+}
+
+class VialTapDance : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dynamic_keymap_reset();
+
+        vial_tap_dance_entry_t td = {KC_A, KC_B, KC_C, KC_D, 150};
+        dynamic_keymap_set_tap_dance(3, &td);
+        vial_init();
+
+        mock_eeprom_reset_counters();
+    }
+};
+
+TEST_F(VialTapDance, TappingTermComesFromEntry) {
+    keyrecord_t record = {};
+
+    EXPECT_EQ(get_tapping_term(QK_TAP_DANCE | 3, &record), 150);
+    EXPECT_EQ(get_tapping_term(QK_TAP_DANCE | 0, &record), TAPPING_TERM);
+    EXPECT_EQ(get_tapping_term(KC_A, &record), TAPPING_TERM);
+}
+
+TEST_F(VialTapDance, NoEepromReadsAfterInit) {
+    keyrecord_t record = {};
+
+    for (int i = 0; i < 1000; ++i) {
+        get_tapping_term(QK_TAP_DANCE | (i % VIAL_TAP_DANCE_ENTRIES), &record);
+    }
+
+    record.event.pressed = false;
+    for (uint8_t i = 0; i < VIAL_TAP_DANCE_ENTRIES; ++i) {
+        tap_dance_actions[i].state.count = 1;
+        process_record_vial(QK_TAP_DANCE | i, &record);
+        tap_dance_actions[i].state.count = 0;
+    }
+
+    EXPECT_EQ(mock_eeprom_reads, 0);
+}
+
+TEST_F(VialTapDance, SetCommandKeepsRamCopyCoherent) {
+    uint8_t                msg[VIAL_RAW_EPSIZE] = {0xFE, vial_dynamic_entry_op, dynamic_vial_tap_dance_set, 3};
+    vial_tap_dance_entry_t td                   = {KC_E, KC_F, KC_G, KC_H, 321};
+    memcpy(&msg[4], &td, sizeof(td));
+    vial_handle_cmd(msg, sizeof(msg));
+    EXPECT_EQ(msg[0], 0);
+
+    keyrecord_t record = {};
+    EXPECT_EQ(get_tapping_term(QK_TAP_DANCE | 3, &record), 321);
+}
+
+TEST_F(VialTapDance, ResetRefreshesRamCopy) {
+    dynamic_keymap_reset();
+
+    keyrecord_t record = {};
+    EXPECT_EQ(get_tapping_term(QK_TAP_DANCE | 3, &record), TAPPING_TERM);
+}
@@ -0,0 +1,40 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "rgb_matrix.h"
+
+led_config_t g_led_config = {{{0, 1, 2, 3}, {4, 5, 6, 7}}, {{0, 0}, {32, 0}, {64, 0}, {96, 0}, {0, 32}, {32, 32}, {64, 32}, {96, 32}}, {4, 4, 4, 4, 4, 4, 4, 4}};
+
+uint8_t rgb_matrix_is_enabled(void) {
+    return true;
+}
+uint8_t rgb_matrix_get_mode(void) {
+    return 0;
+}
+uint8_t rgb_matrix_get_speed(void) {
+    return 0;
+}
+uint8_t rgb_matrix_get_hue(void) {
+    return 0;
+}
+uint8_t rgb_matrix_get_sat(void) {
+    return 0;
+}
+uint8_t rgb_matrix_get_val(void) {
+    return 0;
+}
+void rgb_matrix_enable_noeeprom(void) {}
+void rgb_matrix_disable_noeeprom(void) {}
+void rgb_matrix_mode_noeeprom(uint8_t mode) {}
+void rgb_matrix_set_speed_noeeprom(uint8_t speed) {}
+void rgb_matrix_sethsv_noeeprom(uint16_t hue, uint8_t sat, uint8_t val) {}
+void eeconfig_update_rgb_matrix(void) {}
+
+bool rgb_matrix_map_led_to_row_column(uint8_t led_i, uint8_t *row, uint8_t *column) {
+    return false;
+}
+
+// Pass HSV straight through so tests can see what the legacy fastset stored
+RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+    return (RGB){.r = hsv.h, .g = hsv.s, .b = hsv.v};
+}
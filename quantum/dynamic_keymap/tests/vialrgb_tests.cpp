@@ -0,0 +1,126 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+// rgb_matrix_types.h checks its layouts with C11 _Static_assert
+#define _Static_assert static_assert
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "vial.h"
+#include "vialrgb.h"
+
+extern RGB *g_direct_mode_colors;
+void        vialrgb_direct_frame_start(void);
+}
+
+#include <vector>
+
+class VialRGB : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        // Start every test from a black, presented frame
+        uint8_t clear[VIAL_RAW_EPSIZE] = {0x07, vialrgb_direct_stream, vialrgb_direct_rle565, 0, 0, RGB_MATRIX_LED_COUNT, RGB_MATRIX_LED_COUNT, 0, 0};
+        vialrgb_set_value(clear, sizeof(clear));
+        present();
+    }
+
+    void stream(uint8_t encoding, uint16_t led, uint8_t num_leds, const std::vector<uint8_t> &pixels) {
+        uint8_t msg[VIAL_RAW_EPSIZE] = {0x07, vialrgb_direct_stream, encoding, (uint8_t)(led & 0xFF), (uint8_t)(led >> 8), num_leds};
+        memcpy(&msg[6], pixels.data(), pixels.size());
+        vialrgb_set_value(msg, sizeof(msg));
+    }
+
+    void present(void) {
+        uint8_t msg[VIAL_RAW_EPSIZE] = {0x07, vialrgb_direct_present};
+        vialrgb_set_value(msg, sizeof(msg));
+        vialrgb_direct_frame_start();
+    }
+
+    void expect_led(uint16_t led, uint8_t r, uint8_t g, uint8_t b) {
+        EXPECT_EQ(g_direct_mode_colors[led].r, r) << "led " << led;
+        EXPECT_EQ(g_direct_mode_colors[led].g, g) << "led " << led;
+        EXPECT_EQ(g_direct_mode_colors[led].b, b) << "led " << led;
+    }
+};
+
+TEST_F(VialRGB, StreamRGB888) {
+    stream(vialrgb_direct_rgb888, 1, 2, {10, 20, 30, 40, 50, 60});
+    present();
+    expect_led(0, 0, 0, 0);
+    expect_led(1, 10, 20, 30);
+    expect_led(2, 40, 50, 60);
+    expect_led(3, 0, 0, 0);
+}
+
+TEST_F(VialRGB, StreamRGB565ExpandsToFullRange) {
+    // white, pure red, pure green
+    stream(vialrgb_direct_rgb565, 0, 3, {0xFF, 0xFF, 0x00, 0xF8, 0xE0, 0x07});
+    present();
+    expect_led(0, 255, 255, 255);
+    expect_led(1, 255, 0, 0);
+    expect_led(2, 0, 255, 0);
+}
+
+TEST_F(VialRGB, StreamRunLength565) {
+    // three blue leds followed by two white ones, the last run is cut at num_leds
+    stream(vialrgb_direct_rle565, 2, 5, {3, 0x1F, 0x00, 9, 0xFF, 0xFF});
+    present();
+    expect_led(1, 0, 0, 0);
+    expect_led(2, 0, 0, 255);
+    expect_led(4, 0, 0, 255);
+    expect_led(5, 255, 255, 255);
+    expect_led(6, 255, 255, 255);
+    expect_led(7, 0, 0, 0);
+}
+
+TEST_F(VialRGB, StreamPalette4LowNibbleFirst) {
+    uint8_t palette[VIAL_RAW_EPSIZE] = {0x07, vialrgb_direct_set_palette, 1, 2, 100, 0, 0, 0, 200, 0};
+    vialrgb_set_value(palette, sizeof(palette));
+
+    stream(vialrgb_direct_palette4, 0, 3, {0x21, 0x01});
+    present();
+    expect_led(0, 100, 0, 0);
+    expect_led(1, 0, 200, 0);
+    expect_led(2, 100, 0, 0);
+}
+
+TEST_F(VialRGB, StreamIsClampedToLedCount) {
+    stream(vialrgb_direct_rgb888, RGB_MATRIX_LED_COUNT - 1, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    present();
+    expect_led(RGB_MATRIX_LED_COUNT - 1, 1, 2, 3);
+}
+
+TEST_F(VialRGB, StreamedFrameIsHiddenUntilPresented) {
+    stream(vialrgb_direct_rgb888, 0, 1, {10, 20, 30});
+    vialrgb_direct_frame_start();
+    expect_led(0, 0, 0, 0);
+
+    uint8_t msg[VIAL_RAW_EPSIZE] = {0x07, vialrgb_direct_present};
+    vialrgb_set_value(msg, sizeof(msg));
+    // present only takes effect when the effect starts its next frame
+    expect_led(0, 0, 0, 0);
+    vialrgb_direct_frame_start();
+    expect_led(0, 10, 20, 30);
+}
+
+TEST_F(VialRGB, PresentCarriesFrameOverForPartialUpdates) {
+    stream(vialrgb_direct_rgb888, 0, 1, {10, 20, 30});
+    present();
+    stream(vialrgb_direct_rgb888, 1, 1, {40, 50, 60});
+    present();
+    expect_led(0, 10, 20, 30);
+    expect_led(1, 40, 50, 60);
+}
+
+TEST_F(VialRGB, FastsetIsVisibleImmediatelyAndKeptInBackBuffer) {
+    uint8_t msg[VIAL_RAW_EPSIZE] = {0x07, vialrgb_direct_fastset, 3, 0, 1, 10, 20, 30};
+    vialrgb_set_value(msg, sizeof(msg));
+    expect_led(3, 10, 20, 30);
+
+    stream(vialrgb_direct_rgb888, 0, 1, {1, 2, 3});
+    present();
+    expect_led(0, 1, 2, 3);
+    expect_led(3, 10, 20, 30);
+}
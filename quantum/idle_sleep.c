@@ -0,0 +1,83 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "idle_sleep.h"
+#include "keyboard.h"
+#include "matrix.h"
+#include "suspend.h"
+#include "timer.h"
+
+#ifdef DEFERRED_EXEC_ENABLE
+#    include "deferred_exec.h"
+#endif
+
+// LUFA without INTERRUPT_CONTROL_ENDPOINT and V-USB service control requests from the main loop
+#if (defined(PROTOCOL_LUFA) && !defined(INTERRUPT_CONTROL_ENDPOINT)) || defined(PROTOCOL_VUSB)
+#    define IDLE_SLEEP_USB_POLLED
+#endif
+
+// earliest deadline reported during the current main loop pass
+static uint32_t next_deadline  = UINT32_MAX;
+static uint32_t last_activity  = 0;
+static bool     activity_valid = false;
+
+/** \brief Report that the caller needs to run again within ms, 0 keeps the loop awake for this pass. */
+void idle_sleep_request(uint32_t ms) {
+    if (ms < next_deadline) next_deadline = ms;
+}
+
+/** \brief Keep the loop awake for IDLE_SLEEP_TIMEOUT, for input that isn't a key, encoder or pointing device. */
+void idle_sleep_activity(void) {
+    last_activity  = timer_read32();
+    activity_valid = true;
+}
+
+#ifdef MATRIX_IDLE_SCAN
+// quantum/matrix.c replaces this, custom matrix implementations may too
+__attribute__((weak)) bool matrix_idle_wakeup_armed(void) {
+    return false;
+}
+#endif
+
+__attribute__((weak)) bool idle_sleep_allowed_user(void) {
+    return true;
+}
+
+__attribute__((weak)) bool idle_sleep_allowed_kb(void) {
+    return idle_sleep_allowed_user();
+}
+
+/** \brief How long the loop may sleep after this pass, 0 if it must not. */
+uint32_t idle_sleep_duration(void) {
+    if (last_input_activity_elapsed() < IDLE_SLEEP_TIMEOUT) return 0;
+    // held keys drive repeats, mouse keys and the like without any further input
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix_get_row(row)) return 0;
+    }
+    if (activity_valid) {
+        if (timer_elapsed32(last_activity) < IDLE_SLEEP_TIMEOUT) return 0;
+        activity_valid = false;
+    }
+
+    uint32_t duration = IDLE_SLEEP_MAX_MS;
+#if defined(MATRIX_IDLE_SCAN) && !defined(SPLIT_KEYBOARD) && !defined(ENCODER_ENABLE) && !defined(POINTING_DEVICE_ENABLE) && !defined(IDLE_SLEEP_USB_POLLED)
+    // a key press interrupts the sleep, nothing else needs polling
+    if (matrix_idle_wakeup_armed()) duration = IDLE_SLEEP_INTERRUPT_MAX_MS;
+#endif
+    if (next_deadline < duration) duration = next_deadline;
+#ifdef DEFERRED_EXEC_ENABLE
+    uint32_t deferred = deferred_exec_time_until_next();
+    if (deferred < duration) duration = deferred;
+#endif
+
+    if (duration && !idle_sleep_allowed_kb()) return 0;
+    return duration;
+}
+
+void idle_sleep_task(void) {
+    uint32_t duration = idle_sleep_duration();
+    next_deadline     = UINT32_MAX;
+    if (duration) {
+        suspend_idle(duration);
+    }
+}
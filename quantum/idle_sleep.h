@@ -0,0 +1,39 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+/*
+    Main loop idle sleep.
+
+    Once nothing has been typed for IDLE_SLEEP_TIMEOUT, the main loop sleeps
+    between passes instead of spinning. Subsystems with work pending report
+    when they next need to run with idle_sleep_request() during a pass, and
+    the sleep that follows ends at the earliest deadline, after at most
+    IDLE_SLEEP_MAX_MS, or when an interrupt calls suspend_idle_wakeup().
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// time without key, encoder or pointing device input before the loop may sleep
+#ifndef IDLE_SLEEP_TIMEOUT
+#    define IDLE_SLEEP_TIMEOUT 1000
+#endif
+
+// longest single sleep, the matrix is still polled at least this often
+#ifndef IDLE_SLEEP_MAX_MS
+#    define IDLE_SLEEP_MAX_MS 10
+#endif
+
+// longest single sleep while the matrix is idle with pin change wakeup armed (MATRIX_IDLE_SCAN)
+#ifndef IDLE_SLEEP_INTERRUPT_MAX_MS
+#    define IDLE_SLEEP_INTERRUPT_MAX_MS 100
+#endif
+
+void     idle_sleep_request(uint32_t ms);
+void     idle_sleep_activity(void);
+uint32_t idle_sleep_duration(void);
+void     idle_sleep_task(void);
+
+bool idle_sleep_allowed_kb(void);
+bool idle_sleep_allowed_user(void);
@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "profiling.h"
 #ifdef AUDIO_ENABLE
 #    include "audio.h"
 #endif
@@ -102,12 +103,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
 #ifdef EEPROM_DRIVER
 #    include "eeprom_driver.h"
 #endif
+#if defined(EEPROM_WEAR_LEVELING) && (defined(WEAR_LEVELING_DEFERRED_CONSOLIDATION) || defined(WEAR_LEVELING_WRITE_COALESCING))
+#    include "wear_leveling.h"
+#endif
 #ifdef QMK_SETTINGS
 #   include "qmk_settings.h"
 #endif
@@ -126,6 +133,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef SPLIT_KEYBOARD
 #    include "split_util.h"
 #endif
+#if defined(SPLIT_TRANSPORT_MATRIX_EVENTS) && !defined(DISABLE_SYNC_TIMER)
+#    include "transactions.h"
+#endif
 #ifdef BLUETOOTH_ENABLE
 #    include "bluetooth.h"
 #endif
@@ -378,6 +388,9 @@ __attribute__((weak)) void housekeeping_task_user(void) {}
  * Invokes hooks for executing code after QMK is done after each loop iteration.
  */
 void housekeeping_task(void) {
+#if defined(EEPROM_WEAR_LEVELING) && (defined(WEAR_LEVELING_DEFERRED_CONSOLIDATION) || defined(WEAR_LEVELING_WRITE_COALESCING))
+    wear_leveling_task();
+#endif
     housekeeping_task_kb();
     housekeeping_task_user();
 }
@@ -416,6 +429,9 @@ void keyboard_init(void) {
 #ifdef VIA_ENABLE
     via_init();
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_init();
+#endif
 #ifdef SPLIT_KEYBOARD
     split_pre_init();
 #endif
@@ -521,7 +537,14 @@ static bool matrix_task(void) {
 
     static matrix_row_t matrix_previous[MATRIX_ROWS];
 
-    matrix_scan();
+#ifdef PROFILING_ENABLE
+    static uint32_t last_scan_start = 0;
+    uint32_t        scan_start      = timer_read_us();
+    if (last_scan_start) profiling_record(PROFILE_SCAN_PERIOD, TIMER_DIFF_32(scan_start, last_scan_start));
+    last_scan_start = scan_start;
+#endif
+
+    PROFILE_TASK(PROFILE_MATRIX_SCAN, matrix_scan());
     bool matrix_changed = false;
     for (uint8_t row = 0; row < MATRIX_ROWS && !matrix_changed; row++) {
         matrix_changed |= matrix_previous[row] ^ matrix_get_row(row);
@@ -535,6 +558,11 @@ static bool matrix_task(void) {
         return matrix_changed;
     }
 
+#ifdef LATENCY_TRACE_ENABLE
+    // every change found by this scan dates from the scan, not from when its turn in the loop below comes
+    const uint32_t scan_time_us = timer_read_us() | 1;
+#endif
+
     if (debug_config.matrix) {
         matrix_print();
     }
@@ -555,7 +583,15 @@ static bool matrix_task(void) {
                 const bool key_pressed = current_row & col_mask;
 
                 if (process_keypress) {
-                    action_exec(MAKE_KEYEVENT(row, col, key_pressed));
+                    keyevent_t event = MAKE_KEYEVENT(row, col, key_pressed);
+#ifdef LATENCY_TRACE_ENABLE
+                    event.time_us = scan_time_us;
+#endif
+#if defined(SPLIT_TRANSPORT_MATRIX_EVENTS) && !defined(DISABLE_SYNC_TIMER)
+                    // the other half's changes date from its scan, not from when they got here
+                    split_slave_key_time(row, col, &event.time);
+#endif
+                    PROFILE_TASK(PROFILE_ACTION_EXEC, action_exec(event));
                 }
 
                 switch_events(row, col, key_pressed);
@@ -641,6 +677,14 @@ void quantum_task(void) {
 #ifdef SECURE_ENABLE
     secure_task();
 #endif
+
+#if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_MACRO_ASYNC)
+    dynamic_keymap_macro_task();
+#endif
+
+#if defined(VIAL_ENABLE) && defined(VIAL_DEF_STREAM_ENABLE)
+    vial_task();
+#endif
 }
 
 /** \brief Main task that is repeatedly called as fast as possible. */
@@ -665,7 +709,7 @@ void keyboard_task(void) {
     led_matrix_task();
 #endif
 #ifdef RGB_MATRIX_ENABLE
-    rgb_matrix_task();
+    PROFILE_TASK(PROFILE_RGB_MATRIX, rgb_matrix_task());
 #endif
 
 #if defined(BACKLIGHT_ENABLE)
@@ -689,7 +733,7 @@ void keyboard_task(void) {
 #endif
 
 #ifdef OLED_ENABLE
-    oled_task();
+    PROFILE_TASK(PROFILE_OLED, oled_task());
 #    if OLED_TIMEOUT > 0
     // Wake up oled if user is using those fabulous keys or spinning those encoders!
     if (activity_has_occurred) oled_on();
@@ -730,4 +774,8 @@ void keyboard_task(void) {
 #endif
 
     led_task();
+
+#ifdef PROFILING_ENABLE
+    profiling_task();
+#endif
 }
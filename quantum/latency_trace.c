@@ -0,0 +1,72 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "latency_trace.h"
+#include "timer.h"
+
+#ifdef PROFILING_ENABLE
+#    include "profiling.h"
+#endif
+
+static latency_trace_entry_t entries[LATENCY_TRACE_BUFFER_SIZE];
+static uint8_t               entries_head  = 0;
+static uint8_t               entries_count = 0;
+
+// process_record() can nest (combos replaying buffered keys), the outermost call owns the trace
+static uint8_t    trace_depth = 0;
+static bool       trace_armed = false;
+static keyevent_t trace_event;
+
+void latency_trace_begin(const keyevent_t *event) {
+    if (trace_depth++ > 0 && trace_armed) {
+        // a replayed record is older than the one that triggered the replay
+        if (event->time_us && TIMER_DIFF_32(trace_event.time_us, event->time_us) < UINT32_MAX / 2) {
+            trace_event = *event;
+        }
+        return;
+    }
+    // synthesised records carry no timestamp, tick events are not key presses
+    trace_armed = event->time_us && (event->type == KEY_EVENT || event->type == COMBO_EVENT);
+    trace_event = *event;
+}
+
+void latency_trace_end(void) {
+    if (trace_depth > 0 && --trace_depth == 0) {
+        trace_armed = false;
+    }
+}
+
+void latency_trace_report_sent(void) {
+    if (!trace_armed) return;
+    trace_armed = false;
+
+    // timestamps have their low bit forced on so 0 can mean "untimed", drop it again so they never run ahead
+    uint32_t latency = timer_elapsed_us(trace_event.time_us & ~(uint32_t)1);
+
+    entries[entries_head] = (latency_trace_entry_t){
+        .latency_us = latency,
+        .key        = trace_event.key,
+        .pressed    = trace_event.pressed,
+    };
+    entries_head = (entries_head + 1) % LATENCY_TRACE_BUFFER_SIZE;
+    if (entries_count < LATENCY_TRACE_BUFFER_SIZE) entries_count++;
+
+#ifdef PROFILING_ENABLE
+    profiling_record(PROFILE_KEY_TO_REPORT, latency);
+#endif
+}
+
+uint8_t latency_trace_count(void) {
+    return entries_count;
+}
+
+bool latency_trace_get(uint8_t age, latency_trace_entry_t *entry) {
+    if (age >= entries_count) return false;
+    *entry = entries[(entries_head + LATENCY_TRACE_BUFFER_SIZE - 1 - age) % LATENCY_TRACE_BUFFER_SIZE];
+    return true;
+}
+
+void latency_trace_clear(void) {
+    entries_head  = 0;
+    entries_count = 0;
+}
@@ -0,0 +1,35 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+/*
+    Key to report latency tracer.
+
+    Key events carry the microsecond time of the matrix scan that produced
+    them. When process_record() handles an event and that causes a keyboard
+    report to be sent, the time between the two is stored in a small ring
+    buffer. Tap-hold, combo and other buffering show up here because the
+    original timestamp travels with the buffered record.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "keyboard.h"
+
+#ifndef LATENCY_TRACE_BUFFER_SIZE
+#    define LATENCY_TRACE_BUFFER_SIZE 16
+#endif
+
+typedef struct {
+    uint32_t latency_us;
+    keypos_t key;
+    bool     pressed;
+} latency_trace_entry_t;
+
+void latency_trace_begin(const keyevent_t *event);
+void latency_trace_end(void);
+void latency_trace_report_sent(void);
+
+uint8_t latency_trace_count(void);
+bool    latency_trace_get(uint8_t age, latency_trace_entry_t *entry);
+void    latency_trace_clear(void);
@@ -24,9 +24,19 @@
 #include "keyboard.h"
 #include "sync_timer.h"
 #include "debug.h"
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
+
+#ifdef LED_MATRIX_ASYNC_FLUSH
+#    ifndef I2C_ASYNC
+#        error "LED_MATRIX_ASYNC_FLUSH requires I2C_ASYNC"
+#    endif
+#    include "i2c_master.h"
+#endif
 #include "led_tables.h"
 
 #include <lib/lib8tion/lib8tion.h>
@@ -128,7 +138,34 @@ uint8_t led_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+// Inverse of g_led_config.matrix_co, rebuilt by led_matrix_init() so it follows keyboards that write g_led_config in C
+static led_matrix_pos_t led_matrix_pos[LED_MATRIX_LED_COUNT];
+
+static void led_matrix_init_led_matrix_pos(void) {
+    memset(led_matrix_pos, NO_LED, sizeof(led_matrix_pos));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t led_i = g_led_config.matrix_co[row][col];
+            if (led_i < LED_MATRIX_LED_COUNT && led_matrix_pos[led_i].row == NO_LED) {
+                led_matrix_pos[led_i].row = row;
+                led_matrix_pos[led_i].col = col;
+            }
+        }
+    }
+}
+
+bool led_matrix_map_led_to_row_column(uint8_t led_i, uint8_t *row, uint8_t *column) {
+    if (led_i >= LED_MATRIX_LED_COUNT || led_matrix_pos[led_i].row == NO_LED) return false;
+    *row    = led_matrix_pos[led_i].row;
+    *column = led_matrix_pos[led_i].col;
+    return true;
+}
+
 void led_matrix_update_pwm_buffers(void) {
+#ifdef LED_MATRIX_ASYNC_FLUSH
+    // the driver shares its transfer buffers with a flush that may still be running
+    i2c_async_wait();
+#endif
     led_matrix_driver.flush();
 }
 
@@ -315,6 +352,14 @@ static void led_task_flush(uint8_t effect) {
     led_last_effect = effect;
     led_last_enable = led_matrix_eeconfig.enable;
 
+#ifdef LED_MATRIX_ASYNC_FLUSH
+    // hand the transfer to the I2C thread and get back to scanning
+    if (i2c_async_start(led_matrix_driver.flush)) {
+        led_task_state = FLUSH_PENDING;
+        return;
+    }
+#endif
+
     // update pwm buffers
     led_matrix_update_pwm_buffers();
 
@@ -322,6 +367,13 @@ static void led_task_flush(uint8_t effect) {
     led_task_state = SYNCING;
 }
 
+#ifdef LED_MATRIX_ASYNC_FLUSH
+static void led_task_flush_pending(void) {
+    // effects must not touch the pwm buffers until the driver has sent them
+    if (!i2c_async_busy()) led_task_state = SYNCING;
+}
+#endif
+
 void led_matrix_task(void) {
     led_task_timers();
 
@@ -351,10 +403,25 @@ void led_matrix_task(void) {
         case FLUSHING:
             led_task_flush(effect);
             break;
+        case FLUSH_PENDING:
+#ifdef LED_MATRIX_ASYNC_FLUSH
+            led_task_flush_pending();
+#endif
+            break;
         case SYNCING:
             led_task_sync();
             break;
     }
+
+#ifdef IDLE_SLEEP_ENABLE
+    // a frame is built over several passes, only the wait for the next one can be slept through
+    if (led_task_state == SYNCING) {
+        uint32_t elapsed = sync_timer_elapsed32(g_led_timer);
+        idle_sleep_request(elapsed < LED_MATRIX_LED_FLUSH_LIMIT ? LED_MATRIX_LED_FLUSH_LIMIT - elapsed : 0);
+    } else {
+        idle_sleep_request(0);
+    }
+#endif // IDLE_SLEEP_ENABLE
 }
 
 void led_matrix_indicators(void) {
@@ -419,6 +486,7 @@ struct led_matrix_limits_t led_matrix_get_limits(uint8_t iter) {
 
 void led_matrix_init(void) {
     led_matrix_driver.init();
+    led_matrix_init_led_matrix_pos();
 
 #ifdef LED_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
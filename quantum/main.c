@@ -16,6 +16,10 @@
 
 #include "keyboard.h"
 
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
+
 void platform_setup(void);
 
 void protocol_setup(void);
@@ -72,5 +76,10 @@ int main(void) {
 #endif // DEFERRED_EXEC_ENABLE
 
         housekeeping_task();
+
+#ifdef IDLE_SLEEP_ENABLE
+        // Sleep until something is due
+        idle_sleep_task();
+#endif // IDLE_SLEEP_ENABLE
     }
 }
@@ -20,7 +20,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "debounce.h"
+#include "profiling.h"
 #include "atomic_util.h"
+#ifdef MATRIX_IDLE_SCAN
+#    include "timer.h"
+#    include "suspend.h"
+#endif
 
 #ifdef SPLIT_KEYBOARD
 #    include "split_common/split_util.h"
@@ -51,6 +56,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define MATRIX_INPUT_PRESSED_STATE 0
 #endif
 
+#ifdef MATRIX_IDLE_SCAN
+#    if defined(DIRECT_PINS) || !defined(MATRIX_ROW_PINS) || !defined(MATRIX_COL_PINS)
+#        error MATRIX_IDLE_SCAN needs a row/column matrix (MATRIX_ROW_PINS and MATRIX_COL_PINS)
+#    endif
+#    ifndef MATRIX_IDLE_SCAN_TIMEOUT
+#        define MATRIX_IDLE_SCAN_TIMEOUT 50
+#    endif
+#endif
+
 #ifdef DIRECT_PINS
 static SPLIT_MUTABLE pin_t direct_pins[ROWS_PER_HAND][MATRIX_COLS] = DIRECT_PINS;
 #elif (DIODE_DIRECTION == ROW2COL) || (DIODE_DIRECTION == COL2ROW)
@@ -270,6 +284,181 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_IDLE_SCAN
+/* Idle scanning
+ *
+ * Once every key has been up for MATRIX_IDLE_SCAN_TIMEOUT, all outputs are
+ * selected at once and matrix_scan() only reads the inputs: any key going
+ * down pulls its input to the pressed state. The first such read, or a pin
+ * change interrupt on an input, unselects everything again and full scanning
+ * resumes with the same scan.
+ */
+#    if (DIODE_DIRECTION == COL2ROW)
+#        define IDLE_OUTPUT_COUNT ROWS_PER_HAND
+#        define IDLE_INPUT_COUNT MATRIX_COLS
+#        define idle_output_pins row_pins
+#        define idle_input_pins col_pins
+#        define idle_select select_row
+#        define idle_unselect_all unselect_rows
+#    else
+#        define IDLE_OUTPUT_COUNT MATRIX_COLS
+#        define IDLE_INPUT_COUNT ROWS_PER_HAND
+#        define idle_output_pins col_pins
+#        define idle_input_pins row_pins
+#        define idle_select select_col
+#        define idle_unselect_all unselect_cols
+#    endif
+
+static bool          matrix_idle        = false;
+static bool          matrix_idle_armed  = false;
+static volatile bool matrix_idle_woken  = false;
+static uint32_t      matrix_active_time = 0;
+
+bool matrix_is_idle(void) {
+    return matrix_idle;
+}
+
+bool matrix_idle_wakeup_armed(void) {
+    return matrix_idle && matrix_idle_armed;
+}
+
+void matrix_idle_interrupt(void) {
+    matrix_idle_woken = true;
+    suspend_idle_wakeup();
+}
+
+#    if defined(MATRIX_IDLE_INTERRUPTS) && defined(PROTOCOL_CHIBIOS) && PAL_USE_CALLBACKS && !defined(SPLIT_KEYBOARD)
+// Split transports may enable the EXTI line of a pin with the same number as an input, so split builds stay polled.
+// inputs whose line event was enabled here, so disarming leaves other users of a line alone
+static bool matrix_idle_line_armed[IDLE_INPUT_COUNT];
+
+static void matrix_idle_pal_callback(void *arg) {
+    (void)arg;
+    matrix_idle_interrupt();
+}
+
+__attribute__((weak)) bool matrix_idle_interrupts_enable(void) {
+    bool covered = true;
+    for (uint8_t i = 0; i < IDLE_INPUT_COUNT; i++) {
+        pin_t pin = idle_input_pins[i];
+        if (pin == NO_PIN) continue;
+        // pins with the same number share an EXTI line on some MCUs, only the first one gets it
+        bool taken = false;
+        for (uint8_t j = 0; j < i && !taken; j++) {
+            taken = idle_input_pins[j] != NO_PIN && PAL_PAD(idle_input_pins[j]) == PAL_PAD(pin);
+        }
+        if (taken) {
+            covered = false;
+            continue;
+        }
+        palSetLineCallback(pin, matrix_idle_pal_callback, NULL);
+        palEnableLineEvent(pin, PAL_EVENT_MODE_BOTH_EDGES);
+        matrix_idle_line_armed[i] = true;
+    }
+    return covered;
+}
+
+__attribute__((weak)) void matrix_idle_interrupts_disable(void) {
+    for (uint8_t i = 0; i < IDLE_INPUT_COUNT; i++) {
+        if (matrix_idle_line_armed[i]) {
+            palDisableLineEvent(idle_input_pins[i]);
+            matrix_idle_line_armed[i] = false;
+        }
+    }
+}
+#    elif defined(MATRIX_IDLE_INTERRUPTS) && defined(__AVR__) && defined(PCMSK0) && defined(PCINT0_vect) && defined(PINB_ADDRESS)
+// PCINT0-7 are port B on the supported AVRs, inputs on other ports are only polled
+static uint8_t matrix_idle_pcmsk = 0;
+
+// A keyboard that needs PCINT0 itself defines MATRIX_IDLE_NO_PCINT0_ISR, and calls matrix_idle_interrupt() from its own handler
+#        ifndef MATRIX_IDLE_NO_PCINT0_ISR
+ISR(PCINT0_vect) {
+    matrix_idle_interrupt();
+}
+#        endif
+
+__attribute__((weak)) bool matrix_idle_interrupts_enable(void) {
+    bool covered      = true;
+    matrix_idle_pcmsk = 0;
+    for (uint8_t i = 0; i < IDLE_INPUT_COUNT; i++) {
+        pin_t pin = idle_input_pins[i];
+        if (pin == NO_PIN) continue;
+        if ((pin >> PORT_SHIFTER) == PINB_ADDRESS) {
+            matrix_idle_pcmsk |= _BV(pin & ((1 << PORT_SHIFTER) - 1));
+        } else {
+            covered = false;
+        }
+    }
+    PCMSK0 |= matrix_idle_pcmsk;
+    PCIFR = _BV(PCIF0);
+    PCICR |= _BV(PCIE0);
+    return covered;
+}
+
+__attribute__((weak)) void matrix_idle_interrupts_disable(void) {
+    PCMSK0 &= ~matrix_idle_pcmsk;
+    if (!PCMSK0) PCICR &= ~_BV(PCIE0);
+}
+#    else
+__attribute__((weak)) bool matrix_idle_interrupts_enable(void) {
+    return false;
+}
+
+__attribute__((weak)) void matrix_idle_interrupts_disable(void) {}
+#    endif
+
+static void matrix_idle_enter(void) {
+    for (uint8_t i = 0; i < IDLE_OUTPUT_COUNT; i++) {
+        idle_select(i);
+    }
+    matrix_output_select_delay();
+    matrix_idle_woken = false;
+    matrix_idle_armed = matrix_idle_interrupts_enable();
+    matrix_idle       = true;
+}
+
+static void matrix_idle_leave(void) {
+    matrix_idle_interrupts_disable();
+    matrix_idle       = false;
+    matrix_idle_armed = false;
+    idle_unselect_all();
+    matrix_output_unselect_delay(0, true);
+}
+
+/* true if the matrix needs a full scan */
+static bool matrix_idle_check(void) {
+    if (!matrix_idle) return true;
+
+    bool pressed      = matrix_idle_woken;
+    matrix_idle_woken = false;
+    for (uint8_t i = 0; i < IDLE_INPUT_COUNT && !pressed; i++) {
+        pressed = readMatrixPin(idle_input_pins[i]) == 0;
+    }
+    if (!pressed) return false;
+
+    matrix_idle_leave();
+    matrix_active_time = timer_read32();
+    return true;
+}
+
+static void matrix_idle_update(matrix_row_t current_matrix[]) {
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+#    ifdef SPLIT_KEYBOARD
+        matrix_row_t debounced = matrix[thisHand + row];
+#    else
+        matrix_row_t debounced = matrix[row];
+#    endif
+        if (current_matrix[row] || debounced) {
+            matrix_active_time = timer_read32();
+            return;
+        }
+    }
+    if (!matrix_idle && timer_elapsed32(matrix_active_time) >= MATRIX_IDLE_SCAN_TIMEOUT) {
+        matrix_idle_enter();
+    }
+}
+#endif // MATRIX_IDLE_SCAN
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     // Set pinout for right half if pinout for that half is defined
@@ -323,16 +512,23 @@ __attribute__((weak)) bool transport_master_if_connected(matrix_row_t master_mat
 uint8_t matrix_scan(void) {
     matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
 
+#ifdef MATRIX_IDLE_SCAN
+    // idle is only entered with every key up, so skipping the scan leaves the all-up matrix as is
+    if (matrix_idle_check()) {
+#endif
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
-    // Set row, read cols
-    for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
-        matrix_read_cols_on_row(curr_matrix, current_row);
-    }
+        // Set row, read cols
+        for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
+            matrix_read_cols_on_row(curr_matrix, current_row);
+        }
 #elif (DIODE_DIRECTION == ROW2COL)
-    // Set col, read rows
-    matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
-    for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++, row_shifter <<= 1) {
-        matrix_read_rows_on_col(curr_matrix, current_col, row_shifter);
+        // Set col, read rows
+        matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
+        for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++, row_shifter <<= 1) {
+            matrix_read_rows_on_col(curr_matrix, current_col, row_shifter);
+        }
+#endif
+#ifdef MATRIX_IDLE_SCAN
     }
 #endif
 
@@ -340,10 +536,14 @@ uint8_t matrix_scan(void) {
     if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
 
 #ifdef SPLIT_KEYBOARD
-    changed = debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed) | matrix_post_scan();
+    PROFILE_TASK(PROFILE_DEBOUNCE, changed = debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed));
+    changed |= matrix_post_scan();
 #else
-    changed = debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
+    PROFILE_TASK(PROFILE_DEBOUNCE, changed = debounce(raw_matrix, matrix, ROWS_PER_HAND, changed));
     matrix_scan_kb();
+#endif
+#ifdef MATRIX_IDLE_SCAN
+    matrix_idle_update(curr_matrix);
 #endif
     return (uint8_t)changed;
 }
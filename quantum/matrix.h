@@ -75,6 +75,18 @@ void matrix_scan_kb(void);
 void matrix_init_user(void);
 void matrix_scan_user(void);
 
+#ifdef MATRIX_IDLE_SCAN
+/* whether all lines are selected and only the inputs are watched */
+bool matrix_is_idle(void);
+/* whether every input can wake the MCU by interrupt while idle */
+bool matrix_idle_wakeup_armed(void);
+/* to be called from a pin change interrupt on a matrix input */
+void matrix_idle_interrupt(void);
+/* arm/disarm pin change interrupts on the inputs, returns true if every input is covered */
+bool matrix_idle_interrupts_enable(void);
+void matrix_idle_interrupts_disable(void);
+#endif
+
 #ifdef SPLIT_KEYBOARD
 bool matrix_post_scan(void);
 void matrix_slave_scan_kb(void);
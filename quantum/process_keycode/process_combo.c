@@ -117,6 +117,21 @@ static queued_combo_t combo_buffer[COMBO_BUFFER_LENGTH];
 
 #define INCREMENT_MOD(i) i = (i + 1) % COMBO_BUFFER_LENGTH
 
+#if COMBO_INDEX_SIZE > 0
+/* Every (keycode, combo) pair sorted by keycode, so a key event only visits
+ * the combos that contain it. Combos keep their original order within a
+ * keycode, as overlapping combos are resolved in that order. */
+typedef enum { COMBO_INDEX_STALE, COMBO_INDEX_READY, COMBO_INDEX_OVERFLOW } combo_index_state_t;
+
+static combo_index_state_t combo_index_state = COMBO_INDEX_STALE;
+static uint16_t            combo_index_count = 0;
+static uint32_t            combo_index_filter;
+static uint16_t            combo_index_keycodes[COMBO_INDEX_SIZE];
+static uint8_t             combo_index_combos[COMBO_INDEX_SIZE];
+
+#    define COMBO_INDEX_FILTER_BIT(keycode) ((uint32_t)1 << (((keycode) ^ ((keycode) >> 5) ^ ((keycode) >> 10)) & 31))
+#endif
+
 #ifndef EXTRA_SHORT_COMBOS
 /* flags are their own elements in combo_t struct. */
 #    define COMBO_ACTIVE(combo) (combo->active)
@@ -437,6 +452,66 @@ static bool keys_pressed_in_order(uint16_t combo_index, combo_t *combo, uint16_t
 }
 #endif
 
+void combo_index_invalidate(void) {
+#if COMBO_INDEX_SIZE > 0
+    combo_index_state = COMBO_INDEX_STALE;
+#endif
+}
+
+#if COMBO_INDEX_SIZE > 0
+static void combo_index_build(void) {
+    combo_index_count  = 0;
+    combo_index_filter = 0;
+    combo_index_state  = COMBO_INDEX_OVERFLOW;
+
+    uint16_t count = combo_count();
+    if (count > UINT8_MAX + 1) return;
+
+    for (uint16_t idx = 0; idx < count; ++idx) {
+        const uint16_t *keys = combo_get(idx)->keys;
+        uint16_t        key;
+        for (uint8_t i = 0; (key = pgm_read_word(&keys[i])) != COMBO_END; ++i) {
+            /* a key listed twice must still only be processed once per combo */
+            bool duplicate = false;
+            for (uint8_t j = 0; j < i && !duplicate; ++j) {
+                duplicate = pgm_read_word(&keys[j]) == key;
+            }
+            if (duplicate) continue;
+
+            if (combo_index_count == COMBO_INDEX_SIZE) return;
+
+            /* insertion sort, combos are added in ascending order so equal keycodes stay ordered */
+            uint16_t pos = combo_index_count++;
+            for (; pos > 0 && combo_index_keycodes[pos - 1] > key; --pos) {
+                combo_index_keycodes[pos] = combo_index_keycodes[pos - 1];
+                combo_index_combos[pos]   = combo_index_combos[pos - 1];
+            }
+            combo_index_keycodes[pos] = key;
+            combo_index_combos[pos]   = idx;
+            combo_index_filter |= COMBO_INDEX_FILTER_BIT(key);
+        }
+    }
+
+    combo_index_state = COMBO_INDEX_READY;
+}
+
+/* first index entry for keycode, or combo_index_count if there is none */
+static uint16_t combo_index_find(uint16_t keycode) {
+    if (!(combo_index_filter & COMBO_INDEX_FILTER_BIT(keycode))) return combo_index_count;
+
+    uint16_t lo = 0, hi = combo_index_count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (combo_index_keycodes[mid] < keycode) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+#endif
+
 static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record, uint16_t combo_index) {
     uint8_t  key_count = 0;
     uint16_t key_index = -1;
@@ -587,10 +662,23 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     }
 #endif
 
-    for (uint16_t idx = 0; idx < combo_count(); ++idx) {
-        combo_t *combo = combo_get(idx);
-        is_combo_key |= process_single_combo(combo, keycode, record, idx);
-        no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+#if COMBO_INDEX_SIZE > 0
+    if (combo_index_state == COMBO_INDEX_STALE) {
+        combo_index_build();
+    }
+    if (combo_index_state == COMBO_INDEX_READY) {
+        for (uint16_t pos = combo_index_find(keycode); pos < combo_index_count && combo_index_keycodes[pos] == keycode; ++pos) {
+            uint16_t idx = combo_index_combos[pos];
+            is_combo_key |= process_single_combo(combo_get(idx), keycode, record, idx);
+        }
+    } else
+#endif
+    {
+        for (uint16_t idx = 0; idx < combo_count(); ++idx) {
+            combo_t *combo = combo_get(idx);
+            is_combo_key |= process_single_combo(combo, keycode, record, idx);
+            no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+        }
     }
 
     if (record->event.pressed && is_combo_key) {
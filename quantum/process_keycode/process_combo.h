@@ -39,6 +39,18 @@
 #    define COMBO_BUFFER_LENGTH 4
 #endif
 
+/* Number of (keycode, combo) pairs the keycode index can hold. Keymaps with
+ * more combo keys than this fall back to checking every combo per key event. */
+#ifndef COMBO_INDEX_SIZE
+#    if defined(__AVR__)
+#        define COMBO_INDEX_SIZE 0
+#    elif defined(VIAL_COMBO_ENABLE)
+#        define COMBO_INDEX_SIZE (VIAL_COMBO_ENTRIES * 4)
+#    else
+#        define COMBO_INDEX_SIZE 64
+#    endif
+#endif
+
 typedef struct combo_t {
     const uint16_t *keys;
     uint16_t        keycode;
@@ -77,6 +89,9 @@ bool process_combo(uint16_t keycode, keyrecord_t *record);
 void combo_task(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
 
+/* Call after changing the keys of any combo at runtime. */
+void combo_index_invalidate(void);
+
 void combo_enable(void);
 void combo_disable(void);
 void combo_toggle(void);
@@ -0,0 +1,114 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "profiling.h"
+#include "timer.h"
+#include "debug.h"
+
+typedef struct {
+    uint16_t buckets[PROFILING_BUCKETS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+} profiling_histogram_t;
+
+static profiling_histogram_t histograms[PROFILE_TASK_COUNT];
+
+static uint8_t profiling_bucket(uint32_t us) {
+    uint8_t bucket = 0;
+    while (us && bucket < PROFILING_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void profiling_record(uint8_t task, uint32_t us) {
+    if (task >= PROFILE_TASK_COUNT) return;
+    profiling_histogram_t *hist = &histograms[task];
+
+    if (hist->count == 0 || us < hist->min) hist->min = us;
+    if (us > hist->max) hist->max = us;
+    if (hist->count < UINT32_MAX) hist->count++;
+
+    uint8_t bucket = profiling_bucket(us);
+    if (hist->buckets[bucket] == UINT16_MAX) {
+        // halve everything rather than saturate, the shape of the distribution is kept
+        for (uint8_t i = 0; i < PROFILING_BUCKETS; i++) {
+            hist->buckets[i] >>= 1;
+        }
+    }
+    hist->buckets[bucket]++;
+}
+
+static uint32_t profiling_percentile(const profiling_histogram_t *hist, uint16_t permille) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PROFILING_BUCKETS; i++) {
+        total += hist->buckets[i];
+    }
+    if (total == 0) return 0;
+
+    // smallest bucket that covers the requested share of samples, reported as its upper bound
+    uint32_t target = (total * permille + 999) / 1000;
+    uint32_t seen   = 0;
+    for (uint8_t i = 0; i < PROFILING_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            uint32_t bound = ((uint32_t)1 << i) - 1;
+            return bound < hist->max ? bound : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+void profiling_get_stats(uint8_t task, profiling_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (task >= PROFILE_TASK_COUNT) return;
+    const profiling_histogram_t *hist = &histograms[task];
+
+    stats->count = hist->count;
+    stats->min   = hist->min;
+    stats->max   = hist->max;
+    stats->p50   = profiling_percentile(hist, 500);
+    stats->p99   = profiling_percentile(hist, 990);
+}
+
+void profiling_get_histogram(uint8_t task, uint16_t buckets[PROFILING_BUCKETS]) {
+    if (task >= PROFILE_TASK_COUNT) {
+        memset(buckets, 0, sizeof(uint16_t) * PROFILING_BUCKETS);
+        return;
+    }
+    memcpy(buckets, histograms[task].buckets, sizeof(uint16_t) * PROFILING_BUCKETS);
+}
+
+void profiling_reset(void) {
+    memset(histograms, 0, sizeof(histograms));
+}
+
+void profiling_task(void) {
+#if defined(CONSOLE_ENABLE) && !defined(NO_DEBUG) && PROFILING_PRINT_INTERVAL > 0
+    static const char *const names[PROFILE_TASK_COUNT] = {
+        [PROFILE_MATRIX_SCAN]     = "matrix_scan",
+        [PROFILE_DEBOUNCE]        = "debounce",
+        [PROFILE_ACTION_EXEC]     = "action_exec",
+        [PROFILE_RGB_MATRIX]      = "rgb_matrix",
+        [PROFILE_OLED]            = "oled",
+        [PROFILE_SPLIT_TRANSPORT] = "split_transport",
+        [PROFILE_RAW_HID]         = "raw_hid",
+        [PROFILE_SCAN_PERIOD]     = "scan_period",
+        [PROFILE_KEY_TO_REPORT]   = "key_to_report",
+    };
+    static uint32_t last_print = 0;
+
+    if (!debug_enable || timer_elapsed32(last_print) < PROFILING_PRINT_INTERVAL) return;
+    last_print = timer_read32();
+
+    for (uint8_t task = 0; task < PROFILE_TASK_COUNT; task++) {
+        profiling_stats_t stats;
+        profiling_get_stats(task, &stats);
+        if (stats.count == 0) continue;
+        dprintf("%s: n=%lu min=%lu p50=%lu p99=%lu max=%lu us\n", names[task], (unsigned long)stats.count, (unsigned long)stats.min, (unsigned long)stats.p50, (unsigned long)stats.p99, (unsigned long)stats.max);
+    }
+#endif
+}
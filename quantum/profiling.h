@@ -0,0 +1,72 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+/*
+    Latency histograms for the main loop tasks.
+
+    Each profiled task keeps a log2 histogram of its run time in
+    microseconds plus min/max, so the distribution (p50/p99) can be read
+    back over the console or the Vial protocol instead of a single average.
+
+    Wrap a call to time it; without PROFILING_ENABLE the call is left as is:
+
+        PROFILE_TASK(PROFILE_OLED, oled_task());
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum profiling_task {
+    PROFILE_MATRIX_SCAN,     // matrix_scan(), including debounce and split transport
+    PROFILE_DEBOUNCE,        // debounce()
+    PROFILE_ACTION_EXEC,     // action_exec() of one key event
+    PROFILE_RGB_MATRIX,      // rgb_matrix_task()
+    PROFILE_OLED,            // oled_task()
+    PROFILE_SPLIT_TRANSPORT, // split transport transactions, either half
+    PROFILE_RAW_HID,         // raw_hid_task()
+    PROFILE_SCAN_PERIOD,     // time between the start of two matrix scans
+    PROFILE_KEY_TO_REPORT,   // debounced key change to the keyboard report being sent
+    PROFILE_TASK_COUNT,
+};
+
+// bucket i holds samples below 2^i us, the last one everything longer
+#define PROFILING_BUCKETS 16
+
+#ifndef PROFILING_PRINT_INTERVAL
+#    define PROFILING_PRINT_INTERVAL 10000
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t p50;
+    uint32_t p99;
+} profiling_stats_t;
+
+#ifdef PROFILING_ENABLE
+
+void profiling_record(uint8_t task, uint32_t us);
+void profiling_get_stats(uint8_t task, profiling_stats_t *stats);
+void profiling_get_histogram(uint8_t task, uint16_t buckets[PROFILING_BUCKETS]);
+void profiling_reset(void);
+void profiling_task(void);
+
+#    include "timer.h"
+
+#    define PROFILE_TASK(task, call)                                   \
+        do {                                                           \
+            uint32_t profile_start = timer_read_us();                  \
+            call;                                                      \
+            profiling_record((task), timer_elapsed_us(profile_start)); \
+        } while (0)
+
+#else
+
+#    define PROFILE_TASK(task, call) \
+        do {                         \
+            call;                    \
+        } while (0)
+
+#endif // PROFILING_ENABLE
@@ -17,6 +17,9 @@
 #include "quantum.h"
 #include "magic.h"
 #include "qmk_settings.h"
+#if defined(EEPROM_WEAR_LEVELING) && defined(WEAR_LEVELING_WRITE_COALESCING)
+#    include "wear_leveling.h"
+#endif
 
 #if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
 #    include "process_backlight.h"
@@ -180,6 +183,10 @@ __attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_
 
 void shutdown_quantum(bool jump_to_bootloader) {
     clear_keyboard();
+#if defined(EEPROM_WEAR_LEVELING) && defined(WEAR_LEVELING_WRITE_COALESCING)
+    // Make sure recent EEPROM writes survive the reset
+    wear_leveling_flush();
+#endif
 #if defined(MIDI_ENABLE) && defined(MIDI_BASIC)
     process_midi_all_notes_off();
 #endif
@@ -266,6 +273,17 @@ bool process_record_quantum(keyrecord_t *record) {
     uint16_t keycode = get_record_keycode(record, true);
     return process_record_quantum_helper(keycode, record);
 }
+/* Feature handlers come in two kinds:
+ *  - observers look at every key event (key lock, dynamic macro, repeat key,
+ *    clicky, haptic, VIA/Vial, the keyboard/user hooks, secure, music, caps
+ *    word, key override, tap dance, unicode, leader, auto shift, space cadet,
+ *    autocorrect) and are always called,
+ *  - owners only act on their own keycode range and are only called for it.
+ * The order below is the order the handlers see a key in, and the first one
+ * to return false stops the chain. Observers that must see a key before its
+ * owner consumes it have to stay above that owner. */
+#define PROCESS_OWNED(in_range, handler) (!(in_range) || handler(keycode, record))
+
 /* Core keycode function, hands off handling to other functions,
     then processes internal quantum keycodes, and then processes
     ACTIONs.                                                      */
@@ -336,19 +354,19 @@ bool process_record_quantum_helper(uint16_t keycode, keyrecord_t *record) {
             process_secure(keycode, record) &&
 #endif
 #if defined(SEQUENCER_ENABLE)
-            process_sequencer(keycode, record) &&
+            PROCESS_OWNED(IS_QK_SEQUENCER(keycode), process_sequencer) &&
 #endif
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+            PROCESS_OWNED(IS_QK_MIDI(keycode), process_midi) &&
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+            PROCESS_OWNED(IS_AUDIO_KEYCODE(keycode), process_audio) &&
 #endif
 #if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
-            process_backlight(keycode, record) &&
+            PROCESS_OWNED(IS_BACKLIGHT_KEYCODE(keycode), process_backlight) &&
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+            PROCESS_OWNED(IS_QK_STENO(keycode), process_steno) &&
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
             process_music(keycode, record) &&
@@ -372,31 +390,31 @@ bool process_record_quantum_helper(uint16_t keycode, keyrecord_t *record) {
             process_auto_shift(keycode, record) &&
 #endif
 #ifdef DYNAMIC_TAPPING_TERM_ENABLE
-            process_dynamic_tapping_term(keycode, record) &&
+            PROCESS_OWNED(keycode >= QK_DYNAMIC_TAPPING_TERM_PRINT && keycode <= QK_DYNAMIC_TAPPING_TERM_DOWN, process_dynamic_tapping_term) &&
 #endif
 #ifdef SPACE_CADET_ENABLE
             process_space_cadet(keycode, record) &&
 #endif
 #ifdef MAGIC_ENABLE
-            process_magic(keycode, record) &&
+            PROCESS_OWNED(IS_MAGIC_KEYCODE(keycode), process_magic) &&
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+            PROCESS_OWNED(keycode == QK_GRAVE_ESCAPE, process_grave_esc) &&
 #endif
 #if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+            PROCESS_OWNED(IS_RGB_KEYCODE(keycode), process_rgb) &&
 #endif
 #ifdef JOYSTICK_ENABLE
-            process_joystick(keycode, record) &&
+            PROCESS_OWNED(IS_QK_JOYSTICK(keycode), process_joystick) &&
 #endif
 #ifdef PROGRAMMABLE_BUTTON_ENABLE
-            process_programmable_button(keycode, record) &&
+            PROCESS_OWNED(IS_QK_PROGRAMMABLE_BUTTON(keycode), process_programmable_button) &&
 #endif
 #ifdef AUTOCORRECT_ENABLE
             process_autocorrect(keycode, record) &&
 #endif
 #ifdef TRI_LAYER_ENABLE
-            process_tri_layer(keycode, record) &&
+            PROCESS_OWNED(keycode >= QK_TRI_LAYER_LOWER && keycode <= QK_TRI_LAYER_UPPER, process_tri_layer) &&
 #endif
             true)) {
         return false;
@@ -199,6 +199,10 @@ extern layer_state_t layer_state;
 #    include "wpm.h"
 #endif
 
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency_trace.h"
+#endif
+
 #ifdef USBPD_ENABLE
 #    include "usbpd.h"
 #endif
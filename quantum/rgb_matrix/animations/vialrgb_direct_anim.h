@@ -3,13 +3,16 @@
 RGB_MATRIX_EFFECT(VIALRGB_DIRECT)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
-extern HSV g_direct_mode_colors[RGB_MATRIX_LED_COUNT];
+extern RGB *g_direct_mode_colors;
+void        vialrgb_direct_frame_start(void);
 
 bool VIALRGB_DIRECT(effect_params_t* params) {
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
+    if (params->iter == 0) vialrgb_direct_frame_start();
+
     for (uint8_t i = led_min; i < led_max; i++) {
-        RGB rgb = rgb_matrix_hsv_to_rgb(g_direct_mode_colors[i]);
+        RGB rgb = g_direct_mode_colors[i];
         rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
     }
     return led_max < RGB_MATRIX_LED_COUNT;
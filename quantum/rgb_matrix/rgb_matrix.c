@@ -23,10 +23,24 @@
 #include "keyboard.h"
 #include "sync_timer.h"
 #include "debug.h"
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    ifndef I2C_ASYNC
+#        error "RGB_MATRIX_ASYNC_FLUSH requires I2C_ASYNC"
+#    endif
+// The flush runs on the I2C thread, which only serialises access to the I2C bus
+#    if defined(RGB_MATRIX_AW20216S) || defined(RGB_MATRIX_WS2812)
+#        error "RGB_MATRIX_ASYNC_FLUSH only supports I2C drivers"
+#    endif
+#    include "i2c_master.h"
+#endif
+
 #include <lib/lib8tion/lib8tion.h>
 
 #ifndef RGB_MATRIX_CENTER
@@ -35,9 +49,46 @@ const led_point_t k_rgb_matrix_center = {112, 32};
 const led_point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
-__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+static RGB rgb_matrix_hsv_to_rgb_default(HSV hsv) {
     return hsv_to_rgb(hsv);
 }
+RGB rgb_matrix_hsv_to_rgb(HSV hsv) __attribute__((weak, alias("rgb_matrix_hsv_to_rgb_default")));
+
+void rgb_matrix_hsv_to_rgb_n(const HSV *hsv, RGB *rgb, uint8_t count) {
+    if (rgb_matrix_hsv_to_rgb == rgb_matrix_hsv_to_rgb_default) {
+        hsv_to_rgb_n(hsv, rgb, count);
+        return;
+    }
+    // keyboard level override, it has to see every color
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+}
+
+// Effect runners queue their colors here and convert them in batches
+#ifndef RGB_MATRIX_HSV_BATCH_SIZE
+#    define RGB_MATRIX_HSV_BATCH_SIZE 8
+#endif
+static HSV     rgb_hsv_batch[RGB_MATRIX_HSV_BATCH_SIZE];
+static uint8_t rgb_hsv_batch_led[RGB_MATRIX_HSV_BATCH_SIZE];
+static uint8_t rgb_hsv_batch_count = 0;
+
+static void rgb_matrix_flush_hsv(void) {
+    RGB rgb[RGB_MATRIX_HSV_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_n(rgb_hsv_batch, rgb, rgb_hsv_batch_count);
+    for (uint8_t i = 0; i < rgb_hsv_batch_count; i++) {
+        rgb_matrix_set_color(rgb_hsv_batch_led[i], rgb[i].r, rgb[i].g, rgb[i].b);
+    }
+    rgb_hsv_batch_count = 0;
+}
+
+static void rgb_matrix_set_hsv(uint8_t index, HSV hsv) {
+    rgb_hsv_batch_led[rgb_hsv_batch_count] = index;
+    rgb_hsv_batch[rgb_hsv_batch_count]     = hsv;
+    if (++rgb_hsv_batch_count == RGB_MATRIX_HSV_BATCH_SIZE) {
+        rgb_matrix_flush_hsv();
+    }
+}
 
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
@@ -79,6 +130,15 @@ static rgb_task_states rgb_task_state    = SYNCING;
 #if RGB_MATRIX_TIMEOUT > 0
 static uint32_t rgb_anykey_timer;
 #endif // RGB_MATRIX_TIMEOUT > 0
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+static struct rgb_matrix_limits_t rgb_render_limits;                                   // LEDs covered by the current iteration
+static uint8_t                    rgb_render_chunk    = RGB_MATRIX_LED_PROCESS_LIMIT; // LEDs to render per iteration
+static uint16_t                   rgb_render_led_cost = 0;                            // smoothed cost of one LED in 1/16 us
+static uint32_t                   rgb_render_frame_us = 0;                            // render time of the frame in progress
+static uint16_t                   rgb_render_frames   = 0;                            // frames flushed since rgb_render_stats_timer
+static uint32_t                   rgb_render_stats_timer;
+static rgb_matrix_render_stats_t  rgb_render_stats;
+#endif // RGB_MATRIX_RENDER_BUDGET_US
 
 // double buffers
 static uint32_t rgb_timer_buffer;
@@ -142,7 +202,34 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+// Inverse of g_led_config.matrix_co, rebuilt by rgb_matrix_init() so it follows keyboards that write g_led_config in C
+static led_matrix_pos_t led_matrix_pos[RGB_MATRIX_LED_COUNT];
+
+static void rgb_matrix_init_led_matrix_pos(void) {
+    memset(led_matrix_pos, NO_LED, sizeof(led_matrix_pos));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t led_i = g_led_config.matrix_co[row][col];
+            if (led_i < RGB_MATRIX_LED_COUNT && led_matrix_pos[led_i].row == NO_LED) {
+                led_matrix_pos[led_i].row = row;
+                led_matrix_pos[led_i].col = col;
+            }
+        }
+    }
+}
+
+bool rgb_matrix_map_led_to_row_column(uint8_t led_i, uint8_t *row, uint8_t *column) {
+    if (led_i >= RGB_MATRIX_LED_COUNT || led_matrix_pos[led_i].row == NO_LED) return false;
+    *row    = led_matrix_pos[led_i].row;
+    *column = led_matrix_pos[led_i].col;
+    return true;
+}
+
 void rgb_matrix_update_pwm_buffers(void) {
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    // the driver shares its transfer buffers with a flush that may still be running
+    i2c_async_wait();
+#endif
     rgb_matrix_driver.flush();
 }
 
@@ -277,9 +364,65 @@ static void rgb_task_sync(void) {
     if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
 }
 
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+static void rgb_render_next_limits(uint8_t first) {
+    rgb_render_limits.led_min_index = first;
+    rgb_render_limits.led_max_index = (RGB_MATRIX_LED_COUNT - first > rgb_render_chunk) ? first + rgb_render_chunk : RGB_MATRIX_LED_COUNT;
+#    if defined(RGB_MATRIX_SPLIT)
+    const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
+    if (is_keyboard_left() && (rgb_render_limits.led_max_index > k_rgb_matrix_split[0])) rgb_render_limits.led_max_index = k_rgb_matrix_split[0];
+    if (!(is_keyboard_left()) && (rgb_render_limits.led_min_index < k_rgb_matrix_split[0])) {
+        rgb_render_limits.led_min_index = k_rgb_matrix_split[0];
+        rgb_render_limits.led_max_index = (RGB_MATRIX_LED_COUNT - k_rgb_matrix_split[0] > rgb_render_chunk) ? k_rgb_matrix_split[0] + rgb_render_chunk : RGB_MATRIX_LED_COUNT;
+    }
+#    endif
+}
+
+static void rgb_render_account(uint32_t spent_us) {
+    rgb_render_frame_us += spent_us;
+
+    uint8_t count = rgb_render_limits.led_max_index - rgb_render_limits.led_min_index;
+    if (count == 0) return;
+
+    // Exponentially smoothed per-LED cost. With a coarse time source most
+    // samples read as zero and the odd one as a whole tick, which still
+    // averages out to the right cost.
+    uint32_t cost = (spent_us << 4) / count;
+    if (cost > UINT16_MAX) cost = UINT16_MAX;
+    rgb_render_led_cost = (rgb_render_led_cost * 3 + cost + 3) / 4;
+
+    uint32_t chunk = rgb_render_led_cost ? ((uint32_t)RGB_MATRIX_RENDER_BUDGET_US << 4) / rgb_render_led_cost : RGB_MATRIX_LED_COUNT;
+    if (chunk < 1) chunk = 1;
+    if (chunk > RGB_MATRIX_LED_COUNT) chunk = RGB_MATRIX_LED_COUNT;
+    rgb_render_chunk = chunk;
+}
+
+static void rgb_render_frame_done(void) {
+    if (rgb_render_frame_us > UINT16_MAX) rgb_render_frame_us = UINT16_MAX;
+    rgb_render_stats.render_us = rgb_render_frame_us;
+    rgb_render_stats.chunk     = rgb_render_chunk;
+    rgb_render_frame_us        = 0;
+
+    rgb_render_frames++;
+    uint32_t elapsed = timer_elapsed32(rgb_render_stats_timer);
+    if (elapsed >= 1000) {
+        rgb_render_stats.fps   = (uint32_t)rgb_render_frames * 1000 / elapsed;
+        rgb_render_frames      = 0;
+        rgb_render_stats_timer = timer_read32();
+    }
+}
+
+void rgb_matrix_get_render_stats(rgb_matrix_render_stats_t *stats) {
+    *stats = rgb_render_stats;
+}
+#endif // RGB_MATRIX_RENDER_BUDGET_US
+
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    rgb_render_next_limits(0);
+#endif // RGB_MATRIX_RENDER_BUDGET_US
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
@@ -355,6 +498,17 @@ static void rgb_task_flush(uint8_t effect) {
     // update last trackers after the first full render so we can init over several frames
     rgb_last_effect = effect;
     rgb_last_enable = rgb_matrix_config.enable;
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    rgb_render_frame_done();
+#endif // RGB_MATRIX_RENDER_BUDGET_US
+
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    // hand the transfer to the I2C thread and get back to scanning
+    if (i2c_async_start(rgb_matrix_driver.flush)) {
+        rgb_task_state = FLUSH_PENDING;
+        return;
+    }
+#endif
 
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
@@ -363,6 +517,13 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_task_state = SYNCING;
 }
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+static void rgb_task_flush_pending(void) {
+    // effects must not touch the pwm buffers until the driver has sent them
+    if (!i2c_async_busy()) rgb_task_state = SYNCING;
+}
+#endif
+
 void rgb_matrix_task(void) {
     rgb_task_timers();
 
@@ -380,7 +541,10 @@ void rgb_matrix_task(void) {
         case STARTING:
             rgb_task_start();
             break;
-        case RENDERING:
+        case RENDERING: {
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+            uint32_t render_start = timer_read_us();
+#endif // RGB_MATRIX_RENDER_BUDGET_US
             rgb_task_render(effect);
             if (effect) {
                 if (rgb_task_state == FLUSHING) { // ensure we only draw basic indicators once rendering is finished
@@ -388,14 +552,35 @@ void rgb_matrix_task(void) {
                 }
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+            rgb_render_account(timer_elapsed_us(render_start));
+            // the next iteration picks up where this one stopped, sized from the updated cost
+            rgb_render_next_limits(rgb_render_limits.led_max_index);
+#endif // RGB_MATRIX_RENDER_BUDGET_US
             break;
+        }
         case FLUSHING:
             rgb_task_flush(effect);
             break;
+        case FLUSH_PENDING:
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+            rgb_task_flush_pending();
+#endif
+            break;
         case SYNCING:
             rgb_task_sync();
             break;
     }
+
+#ifdef IDLE_SLEEP_ENABLE
+    // a frame is built over several passes, only the wait for the next one can be slept through
+    if (rgb_task_state == SYNCING) {
+        uint32_t elapsed = sync_timer_elapsed32(g_rgb_timer);
+        idle_sleep_request(elapsed < RGB_MATRIX_LED_FLUSH_LIMIT ? RGB_MATRIX_LED_FLUSH_LIMIT - elapsed : 0);
+    } else {
+        idle_sleep_request(0);
+    }
+#endif // IDLE_SLEEP_ENABLE
 }
 
 void rgb_matrix_indicators(void) {
@@ -411,33 +596,40 @@ __attribute__((weak)) bool rgb_matrix_indicators_user(void) {
 }
 
 struct rgb_matrix_limits_t rgb_matrix_get_limits(uint8_t iter) {
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    // chunk boundaries move with the measured render cost, so only the
+    // iteration in progress has meaningful limits
+    (void)iter;
+    return rgb_render_limits;
+#else
     struct rgb_matrix_limits_t limits = {0};
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
-#    if defined(RGB_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#        if defined(RGB_MATRIX_SPLIT)
     limits.led_min_index = RGB_MATRIX_LED_PROCESS_LIMIT * (iter);
     limits.led_max_index = limits.led_min_index + RGB_MATRIX_LED_PROCESS_LIMIT;
     if (limits.led_max_index > RGB_MATRIX_LED_COUNT) limits.led_max_index = RGB_MATRIX_LED_COUNT;
     uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
     if (is_keyboard_left() && (limits.led_max_index > k_rgb_matrix_split[0])) limits.led_max_index = k_rgb_matrix_split[0];
     if (!(is_keyboard_left()) && (limits.led_min_index < k_rgb_matrix_split[0])) limits.led_min_index = k_rgb_matrix_split[0];
-#    else
+#        else
     limits.led_min_index = RGB_MATRIX_LED_PROCESS_LIMIT * (iter);
     limits.led_max_index = limits.led_min_index + RGB_MATRIX_LED_PROCESS_LIMIT;
     if (limits.led_max_index > RGB_MATRIX_LED_COUNT) limits.led_max_index = RGB_MATRIX_LED_COUNT;
-#    endif
-#else
-#    if defined(RGB_MATRIX_SPLIT)
+#        endif
+#    else
+#        if defined(RGB_MATRIX_SPLIT)
     limits.led_min_index                = 0;
     limits.led_max_index                = RGB_MATRIX_LED_COUNT;
     const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
     if (is_keyboard_left() && (limits.led_max_index > k_rgb_matrix_split[0])) limits.led_max_index = k_rgb_matrix_split[0];
     if (!(is_keyboard_left()) && (limits.led_min_index < k_rgb_matrix_split[0])) limits.led_min_index = k_rgb_matrix_split[0];
-#    else
+#        else
     limits.led_min_index = 0;
     limits.led_max_index = RGB_MATRIX_LED_COUNT;
+#        endif
 #    endif
-#endif
     return limits;
+#endif // RGB_MATRIX_RENDER_BUDGET_US
 }
 
 void rgb_matrix_indicators_advanced(effect_params_t *params) {
@@ -460,6 +652,7 @@ __attribute__((weak)) bool rgb_matrix_indicators_advanced_user(uint8_t led_min,
 
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+    rgb_matrix_init_led_matrix_pos();
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
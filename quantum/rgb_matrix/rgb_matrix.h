@@ -123,6 +123,16 @@ struct rgb_matrix_limits_t rgb_matrix_get_limits(uint8_t iter);
 
 #define RGB_MATRIX_USE_LIMITS(min, max) RGB_MATRIX_USE_LIMITS_ITER(min, max, params->iter)
 
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+typedef struct {
+    uint16_t fps;       // frames flushed during the last second
+    uint16_t render_us; // time spent in effects and indicators for the last frame
+    uint8_t  chunk;     // LEDs currently rendered per task run
+} rgb_matrix_render_stats_t;
+
+void rgb_matrix_get_render_stats(rgb_matrix_render_stats_t *stats);
+#endif // RGB_MATRIX_RENDER_BUDGET_US
+
 #define RGB_MATRIX_INDICATOR_SET_COLOR(i, r, g, b) \
     if (i >= led_min && i < led_max) {             \
         rgb_matrix_set_color(i, r, g, b);          \
@@ -161,6 +171,10 @@ void eeconfig_update_rgb_matrix(void);
 
 uint8_t rgb_matrix_map_row_column_to_led_kb(uint8_t row, uint8_t column, uint8_t *led_i);
 uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *led_i);
+bool    rgb_matrix_map_led_to_row_column(uint8_t led_i, uint8_t *row, uint8_t *column);
+
+RGB  rgb_matrix_hsv_to_rgb(HSV hsv);
+void rgb_matrix_hsv_to_rgb_n(const HSV *hsv, RGB *rgb, uint8_t count);
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
@@ -40,7 +40,7 @@ typedef struct PACKED {
 } last_hit_t;
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 
-typedef enum rgb_task_states { STARTING, RENDERING, FLUSHING, SYNCING } rgb_task_states;
+typedef enum rgb_task_states { STARTING, RENDERING, FLUSHING, FLUSH_PENDING, SYNCING } rgb_task_states;
 
 typedef uint8_t led_flags_t;
 
@@ -55,6 +55,11 @@ typedef struct PACKED {
     uint8_t y;
 } led_point_t;
 
+typedef struct PACKED {
+    uint8_t row;
+    uint8_t col;
+} led_matrix_pos_t;
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 #define HAS_ANY_FLAGS(bits, flags) ((bits & flags) != 0x00)
 
@@ -80,8 +80,13 @@
     { 0, 0, sizeof_member(split_shared_memory_t, member), offsetof(split_shared_memory_t, member), cb }
 #define trans_target2initiator_initializer(member) trans_target2initiator_initializer_cb(member, NULL)
 
-#define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
-#define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+#ifdef SPLIT_TRANSPORT_BATCHING
+#    define transport_write(id, data, length) batch_transport_write(id, data, length)
+#    define transport_read(id, data, length) batch_transport_read(id, data, length)
+#else // SPLIT_TRANSPORT_BATCHING
+#    define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
+#    define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+#endif // SPLIT_TRANSPORT_BATCHING
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 // Forward-declare the RPC callback handlers
@@ -89,6 +94,78 @@ void slave_rpc_info_callback(uint8_t initiator2target_buffer_size, const void *i
 void slave_rpc_exec_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 
+#ifdef SPLIT_TRANSPORT_BATCHING
+// Forward-declare the batch callback handler
+void slave_batch_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
+
+////////////////////////////////////////////////////
+// Batched transport
+//
+// Instead of one round trip per transaction ID, the master performs a single
+// exchange at the start of each scan, and every GET payload comes back in its
+// reply, which is then served to the regular handlers out of shared memory.
+// Dirty PUT payloads are queued while the handlers run and flushed with a
+// second exchange at the end of the same pass, so they are not held back.
+
+static split_batch_m2s_t batch_pending; // master-side frame, kept until the slave acknowledges it
+static uint32_t          batch_fresh;   // transaction IDs answered by the most recent exchange
+
+#    define BATCH_ID_BIT(id) (1UL << (id))
+
+static bool batch_is_queueable(int8_t id) {
+    if (id < 0 || id >= NUM_TOTAL_TRANSACTIONS) return false;
+#    ifndef DISABLE_SYNC_TIMER
+    // The sync timer is time-sensitive, so it should never be held back for a scan
+    if (id == PUT_SYNC_TIMER) return false;
+#    endif // DISABLE_SYNC_TIMER
+#    if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+    if (id >= PUT_RPC_INFO && id <= GET_RPC_RESP_DATA) return false;
+#    endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    return trans->initiator2target_buffer_size && !trans->target2initiator_buffer_size && !trans->slave_callback;
+}
+
+static bool batch_queue(int8_t id, const void *data, size_t length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    uint8_t                   size  = trans->initiator2target_buffer_size;
+
+    // Replace an already-queued record for this transaction in place, otherwise append
+    uint8_t pos = 0;
+    while (pos < batch_pending.length && batch_pending.data[pos] != (uint8_t)id) {
+        pos += 1 + split_transaction_table[batch_pending.data[pos]].initiator2target_buffer_size;
+    }
+    if (pos >= batch_pending.length) {
+        if (batch_pending.length + 1 + size > SPLIT_TRANSPORT_BATCH_SIZE) {
+            return false;
+        }
+        batch_pending.length += 1 + size;
+    }
+
+    // Keep the local copy of shared memory in step, as a direct transaction would
+    memcpy(split_trans_initiator2target_buffer(trans), data, length < size ? length : size);
+    batch_pending.data[pos] = (uint8_t)id;
+    memcpy(&batch_pending.data[pos + 1], split_trans_initiator2target_buffer(trans), size);
+    return true;
+}
+
+static bool batch_transport_write(int8_t id, const void *data, size_t length) {
+    if (batch_is_queueable(id) && batch_queue(id, data, length)) {
+        return true;
+    }
+    return transport_execute_transaction(id, data, length, NULL, 0);
+}
+
+static bool batch_transport_read(int8_t id, void *data, size_t length) {
+    if (id >= 0 && id < NUM_TOTAL_TRANSACTIONS && (batch_fresh & BATCH_ID_BIT(id))) {
+        split_transaction_desc_t *trans = &split_transaction_table[id];
+        memcpy(data, split_trans_target2initiator_buffer(trans), length < trans->target2initiator_buffer_size ? length : trans->target2initiator_buffer_size);
+        return true;
+    }
+    return transport_execute_transaction(id, NULL, 0, data, length);
+}
+
+#endif // SPLIT_TRANSPORT_BATCHING
+
 ////////////////////////////////////////////////////
 // Helpers
 
@@ -170,9 +247,268 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
     return send_if_condition(trans_id, last_update, (memcmp(source, equiv_shmem, length) != 0), source, length);
 }
 
+////////////////////////////////////////////////////
+// Batch exchange
+
+#ifdef SPLIT_TRANSPORT_BATCHING
+
+#    define batch_s2m_checksum(s2m) crc8(&(s2m)->ack, sizeof(split_batch_s2m_t) - offsetof(split_batch_s2m_t, ack))
+
+// Sends whatever is queued, or just fetches the slave state if nothing is
+static bool batch_exchange(split_batch_s2m_t *snapshot) {
+    bool okay;
+    if (batch_pending.length) {
+        batch_pending.checksum = crc8(&batch_pending.length, sizeof(batch_pending.length) + batch_pending.length);
+        okay                   = transport_execute_transaction(PUT_BATCH, &batch_pending, offsetof(split_batch_m2s_t, data) + batch_pending.length, snapshot, sizeof(*snapshot));
+    } else {
+        okay = transport_execute_transaction(GET_BATCH, NULL, 0, snapshot, sizeof(*snapshot));
+    }
+    if (!okay || snapshot->checksum != batch_s2m_checksum(snapshot)) {
+        return false;
+    }
+    // Only drop the queued payloads once the slave has confirmed it applied them
+    if (batch_pending.length && snapshot->ack == batch_pending.checksum) {
+        batch_pending.length = 0;
+    }
+    return true;
+}
+
+static bool batch_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_batch_s2m_t snapshot;
+
+    batch_fresh = 0;
+    // Normally a plain fetch, payloads only travel here when the previous flush failed
+    if (!batch_exchange(&snapshot)) {
+        return false;
+    }
+
+    // Refresh the local copy of shared memory, so the per-feature handlers pick the data up from there
+#    ifdef SPLIT_TRANSPORT_MATRIX_EVENTS
+    memcpy(&split_shmem->smatrix_events, &snapshot.smatrix_events, sizeof(snapshot.smatrix_events));
+    batch_fresh |= BATCH_ID_BIT(GET_SLAVE_MATRIX_HEAD) | BATCH_ID_BIT(GET_SLAVE_MATRIX_EVENTS);
+#    else  // SPLIT_TRANSPORT_MATRIX_EVENTS
+    memcpy(&split_shmem->smatrix, &snapshot.smatrix, sizeof(snapshot.smatrix));
+    batch_fresh |= BATCH_ID_BIT(GET_SLAVE_MATRIX_CHECKSUM) | BATCH_ID_BIT(GET_SLAVE_MATRIX_DATA);
+#    endif // SPLIT_TRANSPORT_MATRIX_EVENTS
+#    ifdef ENCODER_ENABLE
+    memcpy(&split_shmem->encoders, &snapshot.encoders, sizeof(snapshot.encoders));
+    batch_fresh |= BATCH_ID_BIT(GET_ENCODERS_CHECKSUM) | BATCH_ID_BIT(GET_ENCODERS_DATA);
+#    endif // ENCODER_ENABLE
+#    if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    split_shmem->pointing.checksum = snapshot.pointing_checksum;
+    memcpy(&split_shmem->pointing.report, &snapshot.pointing_report, sizeof(snapshot.pointing_report));
+    batch_fresh |= BATCH_ID_BIT(GET_POINTING_CHECKSUM) | BATCH_ID_BIT(GET_POINTING_DATA);
+#    endif // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    return true;
+}
+
+static void batch_flush_master(void) {
+    // Payloads queued by this pass's handlers go out straight away, a failed flush is retried by the next scan's exchange
+    if (batch_pending.length) {
+        split_batch_s2m_t snapshot;
+        batch_exchange(&snapshot);
+    }
+}
+
+static void batch_prepare_snapshot(void) {
+    split_batch_s2m_t *s2m = &split_shmem->batch_s2m;
+#    ifdef SPLIT_TRANSPORT_MATRIX_EVENTS
+    memcpy(&s2m->smatrix_events, &split_shmem->smatrix_events, sizeof(s2m->smatrix_events));
+#    else  // SPLIT_TRANSPORT_MATRIX_EVENTS
+    memcpy(&s2m->smatrix, &split_shmem->smatrix, sizeof(s2m->smatrix));
+#    endif // SPLIT_TRANSPORT_MATRIX_EVENTS
+#    ifdef ENCODER_ENABLE
+    memcpy(&s2m->encoders, &split_shmem->encoders, sizeof(s2m->encoders));
+#    endif // ENCODER_ENABLE
+#    if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    s2m->pointing_checksum = split_shmem->pointing.checksum;
+    memcpy(&s2m->pointing_report, &split_shmem->pointing.report, sizeof(s2m->pointing_report));
+#    endif // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    s2m->checksum = batch_s2m_checksum(s2m);
+}
+
+static void batch_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    // Runs after every other slave handler, so the snapshot reflects this scan
+    batch_prepare_snapshot();
+}
+
+void slave_batch_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    // Ignore the args -- the `split_shmem` already has the frame, and the reply goes back through it too.
+    const split_batch_m2s_t *frame = &split_shmem->batch_m2s;
+
+    bool okay = frame->length <= SPLIT_TRANSPORT_BATCH_SIZE && frame->checksum == crc8(&frame->length, sizeof(frame->length) + frame->length);
+    for (uint8_t pos = 0; okay && pos < frame->length;) {
+        int8_t id = (int8_t)frame->data[pos];
+        okay      = batch_is_queueable(id) && pos + 1 + split_transaction_table[id].initiator2target_buffer_size <= frame->length;
+        if (okay) {
+            split_transaction_desc_t *trans = &split_transaction_table[id];
+            memcpy(split_trans_initiator2target_buffer(trans), &frame->data[pos + 1], trans->initiator2target_buffer_size);
+            pos += 1 + trans->initiator2target_buffer_size;
+        }
+    }
+
+    split_shmem->batch_s2m.ack = okay ? frame->checksum : (uint8_t)~frame->checksum;
+    batch_prepare_snapshot();
+}
+
+// clang-format off
+#    define TRANSACTIONS_BATCH_MASTER() TRANSACTION_HANDLER_MASTER(batch)
+#    define TRANSACTIONS_BATCH_FLUSH_MASTER() batch_flush_master()
+#    define TRANSACTIONS_BATCH_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(batch)
+#    define TRANSACTIONS_BATCH_REGISTRATIONS \
+    [GET_BATCH] = trans_target2initiator_initializer(batch_s2m), \
+    [PUT_BATCH] = { \
+        sizeof_member(split_shared_memory_t, batch_m2s), offsetof(split_shared_memory_t, batch_m2s), \
+        sizeof_member(split_shared_memory_t, batch_s2m), offsetof(split_shared_memory_t, batch_s2m), \
+        slave_batch_callback \
+    },
+// clang-format on
+
+#else // SPLIT_TRANSPORT_BATCHING
+
+#    define TRANSACTIONS_BATCH_MASTER()
+#    define TRANSACTIONS_BATCH_FLUSH_MASTER()
+#    define TRANSACTIONS_BATCH_SLAVE()
+#    define TRANSACTIONS_BATCH_REGISTRATIONS
+
+#endif // SPLIT_TRANSPORT_BATCHING
+
 ////////////////////////////////////////////////////
 // Slave matrix
 
+#ifdef SPLIT_TRANSPORT_MATRIX_EVENTS
+
+#    define matrix_head_checksum(head) crc8(&(head)->sequence, sizeof(split_slave_matrix_head_t) - offsetof(split_slave_matrix_head_t, sequence))
+#    define matrix_events_checksum(sync) crc8((sync)->events, sizeof(split_slave_matrix_events_t) - offsetof(split_slave_matrix_events_t, events))
+
+#    ifndef DISABLE_SYNC_TIMER
+extern uint8_t thatHand;
+
+// Key changes applied to the slave half by this scan, for split_slave_key_time()
+static split_matrix_event_t replayed[SPLIT_MATRIX_EVENT_QUEUE_SIZE];
+static uint8_t              replayed_count = 0;
+
+bool split_slave_key_time(uint8_t row, uint8_t col, uint16_t *time) {
+    for (uint8_t i = 0; i < replayed_count; ++i) {
+        if (replayed[i].row + thatHand == row && replayed[i].col == col) {
+            // The slave's sync timer follows ours, but never trust a time from the future
+            if (TIMER_DIFF_16(timer_read(), replayed[i].time) < 0x8000) {
+                *time = replayed[i].time;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+#    endif // DISABLE_SYNC_TIMER
+
+static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static matrix_row_t         last_matrix[(MATRIX_ROWS) / 2] = {0}; // last replayed matrix, so we can replicate if there are checksum errors
+    static split_matrix_event_t pending[SPLIT_MATRIX_EVENT_QUEUE_SIZE];
+    static uint8_t              pending_count = 0;
+    static uint8_t              last_sequence = 0;
+    static bool                 synced        = false;
+    split_slave_matrix_events_t sync;
+
+#    ifndef DISABLE_SYNC_TIMER
+    replayed_count = 0;
+#    endif // DISABLE_SYNC_TIMER
+
+    // The head alone covers an idle scan, or a single new change
+    bool okay = transport_read(GET_SLAVE_MATRIX_HEAD, &sync.head, sizeof(sync.head));
+    okay      = okay && sync.head.checksum == matrix_head_checksum(&sync.head);
+    if (!okay) {
+        memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+        return false;
+    }
+
+    uint8_t missed = sync.head.sequence - last_sequence;
+    bool    full   = !synced || missed > 1 || pending_count == SPLIT_MATRIX_EVENT_QUEUE_SIZE;
+    if (full) {
+        okay = transport_read(GET_SLAVE_MATRIX_EVENTS, &sync, sizeof(sync));
+        okay = okay && sync.head.checksum == matrix_head_checksum(&sync.head) && sync.checksum == matrix_events_checksum(&sync);
+        if (!okay) {
+            memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+            return false;
+        }
+        missed = sync.head.sequence - last_sequence;
+        if (!synced || missed > SPLIT_MATRIX_EVENT_QUEUE_SIZE - pending_count) {
+            // Too far behind to replay the events, so resynchronise from the matrix snapshot
+            memcpy(last_matrix, sync.matrix, sizeof(last_matrix));
+            pending_count = 0;
+            synced        = true;
+        } else {
+            for (uint8_t i = 1; i <= missed; ++i) {
+                pending[pending_count++] = sync.events[(uint8_t)(last_sequence + i) % SPLIT_MATRIX_EVENT_QUEUE_SIZE];
+            }
+        }
+    } else if (missed) {
+        pending[pending_count++] = sync.head.latest;
+    }
+    last_sequence = sync.head.sequence;
+
+    // Replay in order, but only one transition per key per scan, so a tap shorter than a scan still registers
+    matrix_row_t changed[(MATRIX_ROWS) / 2] = {0};
+    uint8_t      applied                    = 0;
+    for (; applied < pending_count; ++applied) {
+        split_matrix_event_t *event = &pending[applied];
+        if (event->row >= (MATRIX_ROWS) / 2 || event->col >= MATRIX_COLS) {
+            continue;
+        }
+        matrix_row_t mask = (matrix_row_t)1 << event->col;
+        if (changed[event->row] & mask) {
+            break;
+        }
+        changed[event->row] |= mask;
+        if (event->pressed) {
+            last_matrix[event->row] |= mask;
+        } else {
+            last_matrix[event->row] &= ~mask;
+        }
+#    ifndef DISABLE_SYNC_TIMER
+        replayed[replayed_count++] = *event;
+#    endif // DISABLE_SYNC_TIMER
+    }
+    pending_count -= applied;
+    memmove(pending, &pending[applied], pending_count * sizeof(split_matrix_event_t));
+    if (full && !pending_count) {
+        // Every event has been replayed, so the snapshot is authoritative
+        memcpy(last_matrix, sync.matrix, sizeof(last_matrix));
+    }
+
+    // Copy out the last-known-good matrix state to the slave matrix
+    memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+    return true;
+}
+
+static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_slave_matrix_events_t *sync = &split_shmem->smatrix_events;
+    uint16_t                     now  = sync_timer_read();
+    for (uint8_t row = 0; row < (MATRIX_ROWS) / 2; ++row) {
+        matrix_row_t changes = slave_matrix[row] ^ sync->matrix[row];
+        for (uint8_t col = 0; changes; ++col, changes >>= 1) {
+            if (changes & 1) {
+                ++sync->head.sequence;
+                sync->head.latest = (split_matrix_event_t){.row = row, .col = col, .pressed = (slave_matrix[row] >> col) & 1, .time = now};
+                sync->events[sync->head.sequence % SPLIT_MATRIX_EVENT_QUEUE_SIZE] = sync->head.latest;
+            }
+        }
+    }
+    memcpy(sync->matrix, slave_matrix, sizeof(sync->matrix));
+    sync->head.checksum = matrix_head_checksum(&sync->head);
+    sync->checksum      = matrix_events_checksum(sync);
+}
+
+// clang-format off
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+    [GET_SLAVE_MATRIX_HEAD]   = trans_target2initiator_initializer(smatrix_events.head), \
+    [GET_SLAVE_MATRIX_EVENTS] = trans_target2initiator_initializer(smatrix_events),
+// clang-format on
+
+#else // SPLIT_TRANSPORT_MATRIX_EVENTS
+
 static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     static uint32_t     last_update                    = 0;
     static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0}; // last successfully-read matrix, so we can replicate if there are checksum errors
@@ -194,13 +530,15 @@ static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row
 }
 
 // clang-format off
-#define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
     [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
     [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix),
 // clang-format on
 
+#endif // SPLIT_TRANSPORT_MATRIX_EVENTS
+
 ////////////////////////////////////////////////////
 // Master matrix
 
@@ -895,6 +1233,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 #endif // USE_I2C
 
     // clang-format off
+    TRANSACTIONS_BATCH_REGISTRATIONS
     TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS
     TRANSACTIONS_MASTER_MATRIX_REGISTRATIONS
     TRANSACTIONS_ENCODERS_REGISTRATIONS
@@ -925,6 +1264,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 };
 
 bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_BATCH_MASTER();
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
@@ -944,6 +1284,7 @@ bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix
     TRANSACTIONS_HAPTIC_MASTER();
     TRANSACTIONS_ACTIVITY_MASTER();
     TRANSACTIONS_DETECTED_OS_MASTER();
+    TRANSACTIONS_BATCH_FLUSH_MASTER();
     return true;
 }
 
@@ -967,6 +1308,7 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
     TRANSACTIONS_HAPTIC_SLAVE();
     TRANSACTIONS_ACTIVITY_SLAVE();
     TRANSACTIONS_DETECTED_OS_SLAVE();
+    TRANSACTIONS_BATCH_SLAVE();
 }
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -57,6 +57,37 @@ typedef struct _split_slave_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
 } split_slave_matrix_sync_t;
 
+#ifdef SPLIT_TRANSPORT_MATRIX_EVENTS
+#    ifndef SPLIT_MATRIX_EVENT_QUEUE_SIZE
+#        define SPLIT_MATRIX_EVENT_QUEUE_SIZE 8
+#    endif // SPLIT_MATRIX_EVENT_QUEUE_SIZE
+
+_Static_assert(SPLIT_MATRIX_EVENT_QUEUE_SIZE > 0 && SPLIT_MATRIX_EVENT_QUEUE_SIZE <= 128 && (SPLIT_MATRIX_EVENT_QUEUE_SIZE & (SPLIT_MATRIX_EVENT_QUEUE_SIZE - 1)) == 0, "SPLIT_MATRIX_EVENT_QUEUE_SIZE must be a power of two no greater than 128");
+
+typedef struct _split_matrix_event_t {
+    uint8_t  row;
+    uint8_t  col : 7;
+    uint8_t  pressed : 1;
+    uint16_t time; // sync_timer_read() on the slave when the change was scanned
+} split_matrix_event_t;
+
+// Read every scan: the sequence number of the newest key change, and that change
+typedef struct _split_slave_matrix_head_t {
+    uint8_t              checksum;
+    uint8_t              sequence;
+    split_matrix_event_t latest;
+} split_slave_matrix_head_t;
+
+// The most recent key changes on the slave, stored at [sequence % SPLIT_MATRIX_EVENT_QUEUE_SIZE],
+// only read when the head shows more than one new change
+typedef struct _split_slave_matrix_events_t {
+    split_slave_matrix_head_t head;
+    uint8_t                   checksum;
+    split_matrix_event_t      events[SPLIT_MATRIX_EVENT_QUEUE_SIZE];
+    matrix_row_t              matrix[(MATRIX_ROWS) / 2];
+} split_slave_matrix_events_t;
+#endif // SPLIT_TRANSPORT_MATRIX_EVENTS
+
 #ifdef SPLIT_TRANSPORT_MIRROR
 typedef struct _split_master_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
@@ -146,12 +177,49 @@ typedef struct _rpc_sync_info_t {
 #    include "os_detection.h"
 #endif // defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
 
+#ifdef SPLIT_TRANSPORT_BATCHING
+#    ifndef SPLIT_TRANSPORT_BATCH_SIZE
+#        define SPLIT_TRANSPORT_BATCH_SIZE 32
+#    endif // SPLIT_TRANSPORT_BATCH_SIZE
+
+// Dirty master->slave payloads, packed as [transaction id][initiator2target buffer] records
+typedef struct _split_batch_m2s_t {
+    uint8_t checksum;
+    uint8_t length;
+    uint8_t data[SPLIT_TRANSPORT_BATCH_SIZE];
+} split_batch_m2s_t;
+
+// Snapshot of every slave->master payload, returned by each batched exchange
+typedef struct _split_batch_s2m_t {
+    uint8_t                   checksum;
+    uint8_t                   ack;
+#    ifdef SPLIT_TRANSPORT_MATRIX_EVENTS
+    split_slave_matrix_events_t smatrix_events;
+#    else  // SPLIT_TRANSPORT_MATRIX_EVENTS
+    split_slave_matrix_sync_t smatrix;
+#    endif // SPLIT_TRANSPORT_MATRIX_EVENTS
+#    ifdef ENCODER_ENABLE
+    split_slave_encoder_sync_t encoders;
+#    endif // ENCODER_ENABLE
+#    if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    uint8_t        pointing_checksum;
+    report_mouse_t pointing_report;
+#    endif // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+} split_batch_s2m_t;
+
+_Static_assert(sizeof(split_batch_m2s_t) <= 255, "SPLIT_TRANSPORT_BATCH_SIZE too large");
+#endif // SPLIT_TRANSPORT_BATCHING
+
 typedef struct _split_shared_memory_t {
 #ifdef USE_I2C
     int8_t transaction_id;
 #endif // USE_I2C
 
+#ifdef SPLIT_TRANSPORT_MATRIX_EVENTS
+    split_slave_matrix_events_t smatrix_events;
+#else  // SPLIT_TRANSPORT_MATRIX_EVENTS
     split_slave_matrix_sync_t smatrix;
+#endif // SPLIT_TRANSPORT_MATRIX_EVENTS
 
 #ifdef SPLIT_TRANSPORT_MIRROR
     split_master_matrix_sync_t mmatrix;
@@ -230,6 +298,11 @@ typedef struct _split_shared_memory_t {
 #if defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
     os_variant_t detected_os;
 #endif // defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
+
+#ifdef SPLIT_TRANSPORT_BATCHING
+    split_batch_m2s_t batch_m2s;
+    split_batch_s2m_t batch_s2m;
+#endif // SPLIT_TRANSPORT_BATCHING
 } split_shared_memory_t;
 
 extern split_shared_memory_t *const split_shmem;
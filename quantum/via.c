@@ -182,6 +182,12 @@ void via_set_layout_options(uint32_t value) {
 bool process_record_via(uint16_t keycode, keyrecord_t *record) {
     // Handle macros
     if (record->event.pressed) {
+#ifdef DYNAMIC_KEYMAP_MACRO_ASYNC
+        // Pressing any key while a macro is playing stops it
+        if (dynamic_keymap_macro_cancel()) {
+            return false;
+        }
+#endif
         if (keycode >= QK_MACRO && keycode <= QK_MACRO_MAX) {
             uint8_t id = keycode - QK_MACRO;
             dynamic_keymap_macro_send(id);
@@ -211,13 +217,18 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
     uint8_t *command_id   = &(data[0]);
     uint8_t *command_data = &(data[1]);
 
+#if defined(VIAL_ENABLE) && defined(VIAL_DEF_STREAM_ENABLE)
+    // Hold this reply until a running definition stream has been sent in full
+    vial_def_stream_flush();
+#endif
+
 #ifdef VIAL_ENABLE
     /* When unlock is in progress, we can only react to a subset of commands */
     if (vial_unlock_in_progress) {
         if (data[0] != id_vial_prefix)
             goto skip;
         uint8_t cmd = data[1];
-        if (cmd != vial_get_keyboard_id && cmd != vial_get_size && cmd != vial_get_def && cmd != vial_get_unlock_status && cmd != vial_unlock_start && cmd != vial_unlock_poll)
+        if (cmd != vial_get_keyboard_id && cmd != vial_get_size && cmd != vial_get_def && cmd != vial_get_def_stream && cmd != vial_get_unlock_status && cmd != vial_unlock_start && cmd != vial_unlock_poll)
             goto skip;
     }
 #endif
@@ -46,6 +46,14 @@ _Static_assert(sizeof(vial_unlock_combo_rows) == sizeof(vial_unlock_combo_cols),
 
 #include "qmk_settings.h"
 
+#ifdef PROFILING_ENABLE
+#include "profiling.h"
+#endif
+
+#ifdef LATENCY_TRACE_ENABLE
+#include "latency_trace.h"
+#endif
+
 #ifdef VIAL_TAP_DANCE_ENABLE
 static void reload_tap_dance(void);
 #endif
@@ -58,6 +66,20 @@ static void reload_combo(void);
 static void reload_key_override(void);
 #endif
 
+#ifdef VIAL_DEF_STREAM_ENABLE
+#include "raw_hid.h"
+
+/* Each streamed report carries a 2-byte sequence number followed by definition bytes */
+#define VIAL_DEF_STREAM_PAYLOAD (VIAL_RAW_EPSIZE - 2)
+
+static struct {
+    uint32_t offset;
+    uint16_t remaining;
+    uint16_t seq;
+    uint16_t last_tick;
+} vial_def_stream;
+#endif
+
 void vial_init(void) {
 #ifdef VIAL_TAP_DANCE_ENABLE
     reload_tap_dance();
@@ -70,6 +92,44 @@ void vial_init(void) {
 #endif
 }
 
+#ifdef VIAL_DEF_STREAM_ENABLE
+static void vial_def_stream_send(void) {
+    uint8_t report[VIAL_RAW_EPSIZE] = { 0 };
+    uint32_t len = sizeof(keyboard_definition) - vial_def_stream.offset;
+    if (len > VIAL_DEF_STREAM_PAYLOAD)
+        len = VIAL_DEF_STREAM_PAYLOAD;
+    report[0] = vial_def_stream.seq & 0xFF;
+    report[1] = (vial_def_stream.seq >> 8) & 0xFF;
+    memcpy_P(&report[2], &keyboard_definition[vial_def_stream.offset], len);
+    raw_hid_send(report, sizeof(report));
+
+    vial_def_stream.offset += len;
+    vial_def_stream.seq++;
+    vial_def_stream.remaining--;
+}
+
+void vial_task(void) {
+    if (!vial_def_stream.remaining)
+        return;
+
+    /* Pace the stream to one report per millisecond, matching the raw HID polling interval,
+       so that raw_hid_send() never has to block the main loop waiting for a free buffer */
+    uint16_t now = timer_read();
+    if (now == vial_def_stream.last_tick)
+        return;
+    vial_def_stream.last_tick = now;
+
+    vial_def_stream_send();
+}
+
+/* Stream reports carry no command tag, so the host tells them apart from replies purely by count:
+   the `count` reports announced by vial_get_def_stream always come before the reply to any later command */
+void vial_def_stream_flush(void) {
+    while (vial_def_stream.remaining)
+        vial_def_stream_send();
+}
+#endif
+
 __attribute__((unused)) static uint16_t vial_keycode_firewall(uint16_t in) {
     if (in == QK_BOOT && !vial_unlocked)
         return 0;
@@ -119,6 +179,41 @@ void vial_handle_cmd(uint8_t *msg, uint8_t length) {
             memcpy_P(msg, &keyboard_definition[start], end - start);
             break;
         }
+#ifdef VIAL_DEF_STREAM_ENABLE
+        /* Start streaming the definition from a byte offset, the reports themselves are sent from vial_task() */
+        case vial_get_def_stream: {
+            uint32_t sz = sizeof(keyboard_definition);
+            uint32_t start = msg[2] | (msg[3] << 8) | ((uint32_t)msg[4] << 16) | ((uint32_t)msg[5] << 24);
+            uint32_t count = msg[6] | (msg[7] << 8);
+            uint32_t available = start < sz ? (sz - start + VIAL_DEF_STREAM_PAYLOAD - 1) / VIAL_DEF_STREAM_PAYLOAD : 0;
+            if (count == 0 || count > available)
+                count = available;
+            if (count > UINT16_MAX)
+                count = UINT16_MAX;
+
+            vial_def_stream.offset = start;
+            vial_def_stream.remaining = count;
+            vial_def_stream.seq = 0;
+            vial_def_stream.last_tick = timer_read();
+
+            memset(msg, 0, length);
+            msg[0] = sz & 0xFF;
+            msg[1] = (sz >> 8) & 0xFF;
+            msg[2] = (sz >> 16) & 0xFF;
+            msg[3] = (sz >> 24) & 0xFF;
+            msg[4] = VIAL_KEYBOARD_DEFINITION_CRC32 & 0xFF;
+            msg[5] = (VIAL_KEYBOARD_DEFINITION_CRC32 >> 8) & 0xFF;
+            msg[6] = (VIAL_KEYBOARD_DEFINITION_CRC32 >> 16) & 0xFF;
+            msg[7] = (VIAL_KEYBOARD_DEFINITION_CRC32 >> 24) & 0xFF;
+            msg[8] = start & 0xFF;
+            msg[9] = (start >> 8) & 0xFF;
+            msg[10] = (start >> 16) & 0xFF;
+            msg[11] = (start >> 24) & 0xFF;
+            msg[12] = count & 0xFF;
+            msg[13] = (count >> 8) & 0xFF;
+            break;
+        }
+#endif
 #ifdef ENCODER_MAP_ENABLE
         case vial_get_encoder: {
             uint8_t layer = msg[2];
@@ -287,6 +382,72 @@ void vial_handle_cmd(uint8_t *msg, uint8_t length) {
 
             break;
         }
+#if defined(PROFILING_ENABLE) || defined(LATENCY_TRACE_ENABLE)
+        case vial_profiling_op: {
+            switch (msg[2]) {
+#ifdef PROFILING_ENABLE
+            case vial_profiling_get_stats: {
+                profiling_stats_t stats;
+                profiling_get_stats(msg[3], &stats);
+                uint32_t values[] = { stats.count, stats.min, stats.max, stats.p50, stats.p99 };
+                memset(msg, 0, length);
+                msg[0] = PROFILE_TASK_COUNT;
+                msg[1] = PROFILING_BUCKETS;
+                for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+                    msg[2 + i * 4] = values[i] & 0xFF;
+                    msg[3 + i * 4] = (values[i] >> 8) & 0xFF;
+                    msg[4 + i * 4] = (values[i] >> 16) & 0xFF;
+                    msg[5 + i * 4] = (values[i] >> 24) & 0xFF;
+                }
+                break;
+            }
+            case vial_profiling_get_histogram: {
+                uint16_t buckets[PROFILING_BUCKETS];
+                profiling_get_histogram(msg[3], buckets);
+                for (uint8_t i = 0; i < PROFILING_BUCKETS; ++i) {
+                    msg[i * 2] = buckets[i] & 0xFF;
+                    msg[i * 2 + 1] = buckets[i] >> 8;
+                }
+                break;
+            }
+            case vial_profiling_reset: {
+                profiling_reset();
+#ifdef LATENCY_TRACE_ENABLE
+                latency_trace_clear();
+#endif
+                break;
+            }
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+            /* most recent key to report latencies, msg[3] entries back
+               reply: [0] entries buffered, [1] entries returned, then 7 bytes per entry from [2]:
+               latency_us (32-bit little endian), row, col, pressed (1) or released (0) */
+            case vial_profiling_get_latencies: {
+                uint8_t age = msg[3];
+                memset(msg, 0, length);
+                msg[0] = latency_trace_count();
+                for (uint8_t i = 0; i < (length - 2) / 7; ++i) {
+                    latency_trace_entry_t entry;
+                    if (age + i >= msg[0] || !latency_trace_get(age + i, &entry))
+                        break;
+                    uint8_t *out = &msg[2 + i * 7];
+                    out[0] = entry.latency_us & 0xFF;
+                    out[1] = (entry.latency_us >> 8) & 0xFF;
+                    out[2] = (entry.latency_us >> 16) & 0xFF;
+                    out[3] = (entry.latency_us >> 24) & 0xFF;
+                    out[4] = entry.key.row;
+                    out[5] = entry.key.col;
+                    out[6] = entry.pressed;
+                    msg[1] = i + 1;
+                }
+                break;
+            }
+#endif
+            }
+
+            break;
+        }
+#endif
     }
 }
 
@@ -340,6 +501,16 @@ enum {
 
 static uint8_t dance_state[VIAL_TAP_DANCE_ENTRIES];
 static vial_tap_dance_entry_t td_entry;
+/* RAM copy of the tap dance entries, refreshed by reload_tap_dance() */
+static vial_tap_dance_entry_t td_entries[VIAL_TAP_DANCE_ENTRIES];
+
+static int vial_get_tap_dance(uint8_t index, vial_tap_dance_entry_t *out) {
+    if (index >= VIAL_TAP_DANCE_ENTRIES)
+        return -1;
+
+    memcpy(out, &td_entries[index], sizeof(*out));
+    return 0;
+}
 
 static uint8_t dance_step(tap_dance_state_t *state) {
     if (state->count == 1) {
@@ -355,7 +526,7 @@ static uint8_t dance_step(tap_dance_state_t *state) {
 
 static void on_dance(tap_dance_state_t *state, void *user_data) {
     uint8_t index = (uintptr_t)user_data;
-    if (dynamic_keymap_get_tap_dance(index, &td_entry) != 0)
+    if (vial_get_tap_dance(index, &td_entry) != 0)
         return;
     uint16_t kc = td_entry.on_tap;
     if (kc) {
@@ -371,7 +542,7 @@ static void on_dance(tap_dance_state_t *state, void *user_data) {
 
 static void on_dance_finished(tap_dance_state_t *state, void *user_data) {
     uint8_t index = (uintptr_t)user_data;
-    if (dynamic_keymap_get_tap_dance(index, &td_entry) != 0)
+    if (vial_get_tap_dance(index, &td_entry) != 0)
         return;
     dance_state[index] = dance_step(state);
     switch (dance_state[index]) {
@@ -424,7 +595,7 @@ static void on_dance_finished(tap_dance_state_t *state, void *user_data) {
 
 static void on_dance_reset(tap_dance_state_t *state, void *user_data) {
     uint8_t index = (uintptr_t)user_data;
-    if (dynamic_keymap_get_tap_dance(index, &td_entry) != 0)
+    if (vial_get_tap_dance(index, &td_entry) != 0)
         return;
     qs_wait_ms(QS_tap_code_delay);
     uint8_t st = dance_state[index];
@@ -477,13 +648,16 @@ static void on_dance_reset(tap_dance_state_t *state, void *user_data) {
 
 tap_dance_action_t tap_dance_actions[VIAL_TAP_DANCE_ENTRIES] = { };
 
-/* Load timings from eeprom into custom_tapping_term */
+/* Load entries and timings from eeprom, so that key events and tapping term queries don't have to */
 static void reload_tap_dance(void) {
     for (size_t i = 0; i < VIAL_TAP_DANCE_ENTRIES; ++i) {
         tap_dance_actions[i].fn.on_each_tap = on_dance;
         tap_dance_actions[i].fn.on_dance_finished = on_dance_finished;
         tap_dance_actions[i].fn.on_reset = on_dance_reset;
         tap_dance_actions[i].user_data = (void*)i;
+
+        if (dynamic_keymap_get_tap_dance(i, &td_entries[i]) != 0)
+            memset(&td_entries[i], 0, sizeof(td_entries[i]));
     }
 }
 #endif
@@ -493,7 +667,7 @@ uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
 #ifdef VIAL_TAP_DANCE_ENABLE
     if (keycode >= QK_TAP_DANCE && keycode <= QK_TAP_DANCE_MAX) {
         vial_tap_dance_entry_t td;
-        if (dynamic_keymap_get_tap_dance(keycode & 0xFF, &td) == 0)
+        if (vial_get_tap_dance(keycode & 0xFF, &td) == 0)
             return td.custom_tapping_term;
     }
 #endif
@@ -525,6 +699,8 @@ static void reload_combo(void) {
             key_combos[i].keycode = entry.output;
         }
     }
+
+    combo_index_invalidate();
 }
 #endif
 
@@ -537,7 +713,7 @@ bool process_record_vial(uint16_t keycode, keyrecord_t *record) {
     /* process releases before tap-dance timeout arrives */
     if (!record->event.pressed && keycode >= QK_TAP_DANCE && keycode <= QK_TAP_DANCE_MAX) {
         uint16_t idx = keycode - QK_TAP_DANCE;
-        if (dynamic_keymap_get_tap_dance(idx, &td_entry) != 0)
+        if (vial_get_tap_dance(idx, &td_entry) != 0)
             return true;
 
         tap_dance_action_t *action = &tap_dance_actions[idx];
@@ -27,6 +27,10 @@
 
 void vial_init(void);
 void vial_handle_cmd(uint8_t *data, uint8_t length);
+#ifdef VIAL_DEF_STREAM_ENABLE
+void vial_task(void);
+void vial_def_stream_flush(void);
+#endif
 bool process_record_vial(uint16_t keycode, keyrecord_t *record);
 
 extern int vial_unlocked;
@@ -48,6 +52,15 @@ enum {
     vial_qmk_settings_set = 0x0B,
     vial_qmk_settings_reset = 0x0C,
     vial_dynamic_entry_op = 0x0D,  /* operate on tapdance, combos, etc */
+    vial_get_def_stream = 0x0E,
+    vial_profiling_op = 0x0F,
+};
+
+enum {
+    vial_profiling_get_stats = 0x00,
+    vial_profiling_get_histogram = 0x01,
+    vial_profiling_reset = 0x02,
+    vial_profiling_get_latencies = 0x03,
 };
 
 enum {
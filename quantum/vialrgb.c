@@ -7,6 +7,7 @@
 #include <string.h>
 #include "rgb_matrix.h"
 #include "vial.h"
+#include <lib/lib8tion/lib8tion.h>
 
 typedef struct {
     uint16_t vialrgb_id;
@@ -18,7 +19,18 @@ typedef struct {
 #define SUPPORTED_MODES_LENGTH (sizeof(supported_modes)/sizeof(*supported_modes))
 
 #ifdef RGB_MATRIX_EFFECT_VIALRGB_DIRECT
-HSV g_direct_mode_colors[RGB_MATRIX_LED_COUNT];
+#ifdef VIALRGB_DIRECT_STREAM
+/* Direct mode is double buffered: the effect renders from the front buffer, streamed
+   frames are assembled in the back buffer and swapped in at the start of a frame */
+static RGB direct_mode_buffers[2][RGB_MATRIX_LED_COUNT];
+RGB *g_direct_mode_colors = direct_mode_buffers[0];
+static RGB *direct_mode_back = direct_mode_buffers[1];
+static bool direct_mode_present_pending;
+static RGB direct_mode_palette[VIALRGB_PALETTE_SIZE];
+#else
+static RGB direct_mode_buffer[RGB_MATRIX_LED_COUNT];
+RGB *g_direct_mode_colors = direct_mode_buffer;
+#endif
 #endif
 
 static void get_supported(uint8_t *args, uint8_t length) {
@@ -74,17 +86,10 @@ static void set_mode(uint16_t mode) {
 }
 
 #ifdef RGB_MATRIX_EFFECT_VIALRGB_DIRECT
-static void get_matrix_pos_for_led(uint16_t led, uint8_t *output) {
-    /* reset initially so if we cannot locate the led, it's considered not part of kb matrix */
-    output[0] = output[1] = 0xFF;
-    /* this is kinda O(n^2) but what can you do */
-    for (size_t row = 0; row < MATRIX_ROWS; ++row)
-        for (size_t col = 0; col < MATRIX_COLS; ++col)
-            if (g_led_config.matrix_co[row][col] == led) {
-                output[0] = row;
-                output[1] = col;
-                return;
-            }
+static void get_matrix_pos_for_led(uint8_t led, uint8_t *output) {
+    /* if we cannot locate the led, it's considered not part of kb matrix */
+    if (!rgb_matrix_map_led_to_row_column(led, &output[0], &output[1]))
+        output[0] = output[1] = 0xFF;
 }
 
 static void fast_set_leds(uint8_t *args, size_t length) {
@@ -102,12 +107,102 @@ static void fast_set_leds(uint8_t *args, size_t length) {
     for (size_t i = 0; i < num_leds; ++i) {
         if (i + first_index >= RGB_MATRIX_LED_COUNT)
             break;
-        g_direct_mode_colors[i + first_index].h = args[i * 3 + 0];
-        g_direct_mode_colors[i + first_index].s = args[i * 3 + 1];
         uint8_t val = args[i * 3 + 2];
-        g_direct_mode_colors[i + first_index].v = (val > RGB_MATRIX_MAXIMUM_BRIGHTNESS) ? RGB_MATRIX_MAXIMUM_BRIGHTNESS : val;
+        HSV hsv = { args[i * 3 + 0], args[i * 3 + 1], (val > RGB_MATRIX_MAXIMUM_BRIGHTNESS) ? RGB_MATRIX_MAXIMUM_BRIGHTNESS : val };
+        g_direct_mode_colors[i + first_index] = rgb_matrix_hsv_to_rgb(hsv);
+#ifdef VIALRGB_DIRECT_STREAM
+        /* legacy command takes effect immediately, keep the back buffer in step for later streamed frames */
+        direct_mode_back[i + first_index] = g_direct_mode_colors[i + first_index];
+#endif
+    }
+}
+
+#ifdef VIALRGB_DIRECT_STREAM
+
+static RGB direct_mode_limit(uint8_t r, uint8_t g, uint8_t b) {
+#if RGB_MATRIX_MAXIMUM_BRIGHTNESS < UINT8_MAX
+    return (RGB){ .r = scale8(r, RGB_MATRIX_MAXIMUM_BRIGHTNESS), .g = scale8(g, RGB_MATRIX_MAXIMUM_BRIGHTNESS), .b = scale8(b, RGB_MATRIX_MAXIMUM_BRIGHTNESS) };
+#else
+    return (RGB){ .r = r, .g = g, .b = b };
+#endif
+}
+
+static RGB direct_mode_from_rgb565(const uint8_t *src) {
+    uint16_t c = src[0] | (src[1] << 8);
+    uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    return direct_mode_limit((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+}
+
+static void direct_mode_set_palette(uint8_t *args, size_t length) {
+    /* First palette index, number of entries, followed by RGB888 for the entries */
+    if (length < 2) return;
+
+    uint8_t first = args[0];
+    uint8_t count = args[1];
+    length -= 2;
+    args += 2;
+
+    if (count * 3 > length) return;
+
+    for (size_t i = 0; i < count && i + first < VIALRGB_PALETTE_SIZE; ++i)
+        direct_mode_palette[i + first] = direct_mode_limit(args[i * 3 + 0], args[i * 3 + 1], args[i * 3 + 2]);
+}
+
+static void direct_mode_stream(uint8_t *args, size_t length) {
+    /* Encoding, 2 bytes index of the first led, number of leds, followed by the encoded pixels.
+       Pixels go to the back buffer and only become visible after vialrgb_direct_present */
+    if (length < 4) return;
+
+    uint8_t encoding = args[0];
+    uint16_t led = args[1] | (args[2] << 8);
+    uint8_t num_leds = args[3];
+    length -= 4;
+    args += 4;
+
+    if (led >= RGB_MATRIX_LED_COUNT) return;
+    if (num_leds > RGB_MATRIX_LED_COUNT - led)
+        num_leds = RGB_MATRIX_LED_COUNT - led;
+
+    switch (encoding) {
+    case vialrgb_direct_rgb888:
+        for (size_t i = 0; i < num_leds && (i + 1) * 3 <= length; ++i)
+            direct_mode_back[led + i] = direct_mode_limit(args[i * 3 + 0], args[i * 3 + 1], args[i * 3 + 2]);
+        break;
+    case vialrgb_direct_rgb565:
+        for (size_t i = 0; i < num_leds && (i + 1) * 2 <= length; ++i)
+            direct_mode_back[led + i] = direct_mode_from_rgb565(&args[i * 2]);
+        break;
+    case vialrgb_direct_rle565:
+        /* runs of (number of leds, RGB565 color) */
+        for (size_t pos = 0; num_leds && pos + 3 <= length; pos += 3) {
+            RGB color = direct_mode_from_rgb565(&args[pos + 1]);
+            for (uint8_t run = args[pos]; run && num_leds; --run, --num_leds)
+                direct_mode_back[led++] = color;
+        }
+        break;
+    case vialrgb_direct_palette4:
+        /* two 4-bit palette indices per byte, low nibble first */
+        for (size_t i = 0; i < num_leds && i / 2 < length; ++i)
+            direct_mode_back[led + i] = direct_mode_palette[(args[i / 2] >> ((i & 1) * 4)) & 0x0F];
+        break;
     }
 }
+
+void vialrgb_direct_frame_start(void) {
+    /* Called by the VIALRGB_DIRECT effect at the start of every frame, so a presented frame never tears */
+    if (!direct_mode_present_pending)
+        return;
+    direct_mode_present_pending = false;
+
+    RGB *front = direct_mode_back;
+    direct_mode_back = g_direct_mode_colors;
+    g_direct_mode_colors = front;
+    /* hosts may only stream the leds that changed, so carry the current frame over */
+    memcpy(direct_mode_back, g_direct_mode_colors, sizeof(direct_mode_buffers[0]));
+}
+#else
+void vialrgb_direct_frame_start(void) {}
+#endif
 #endif
 
 void vialrgb_get_value(uint8_t *data, uint8_t length) {
@@ -121,6 +216,13 @@ void vialrgb_get_value(uint8_t *data, uint8_t length) {
         args[0] = VIALRGB_PROTOCOL_VERSION & 0xFF;
         args[1] = VIALRGB_PROTOCOL_VERSION >> 8;
         args[2] = RGB_MATRIX_MAXIMUM_BRIGHTNESS;
+        args[3] = 0;
+#if defined(RGB_MATRIX_EFFECT_VIALRGB_DIRECT) && defined(VIALRGB_DIRECT_STREAM)
+        args[3] |= VIALRGB_CAP_DIRECT_STREAM;
+#endif
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+        args[3] |= VIALRGB_CAP_RENDER_STATS;
+#endif
         break;
     case vialrgb_get_mode: {
         uint16_t vialrgb_id = get_mode();
@@ -136,6 +238,20 @@ void vialrgb_get_value(uint8_t *data, uint8_t length) {
         get_supported(args, length - 2);
         break;
     }
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    case vialrgb_get_render_stats: {
+        rgb_matrix_render_stats_t stats;
+        rgb_matrix_get_render_stats(&stats);
+        args[0] = stats.fps & 0xFF;
+        args[1] = stats.fps >> 8;
+        args[2] = stats.render_us & 0xFF;
+        args[3] = stats.render_us >> 8;
+        args[4] = stats.chunk;
+        args[5] = RGB_MATRIX_RENDER_BUDGET_US & 0xFF;
+        args[6] = RGB_MATRIX_RENDER_BUDGET_US >> 8;
+        break;
+    }
+#endif
 #ifdef RGB_MATRIX_EFFECT_VIALRGB_DIRECT
     case vialrgb_get_number_leds: {
         args[0] = RGB_MATRIX_LED_COUNT & 0xFF;
@@ -143,7 +259,7 @@ void vialrgb_get_value(uint8_t *data, uint8_t length) {
         break;
     }
     case vialrgb_get_led_info: {
-        uint16_t led = (args[0] & 0xFF) | (args[1] >> 8);
+        uint16_t led = args[0] | (args[1] << 8);
         if (led >= RGB_MATRIX_LED_COUNT) return;
         // x, y
         args[0] = g_led_config.point[led].x;
@@ -151,7 +267,7 @@ void vialrgb_get_value(uint8_t *data, uint8_t length) {
         // flags
         args[2] = g_led_config.flags[led];
         // position in keyboard matrix (if it's keyboard LED, otherwise 0xFF)
-        get_matrix_pos_for_led(led, &args[3]);
+        get_matrix_pos_for_led((uint8_t)led, &args[3]);
         break;
     }
 #endif
@@ -177,6 +293,20 @@ void vialrgb_set_value(uint8_t *data, uint8_t length) {
         fast_set_leds(args, length);
         break;
     }
+#ifdef VIALRGB_DIRECT_STREAM
+    case vialrgb_direct_stream: {
+        direct_mode_stream(args, length - 2);
+        break;
+    }
+    case vialrgb_direct_set_palette: {
+        direct_mode_set_palette(args, length - 2);
+        break;
+    }
+    case vialrgb_direct_present: {
+        direct_mode_present_pending = true;
+        break;
+    }
+#endif
 #endif
     }
 }
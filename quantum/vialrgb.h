@@ -11,14 +11,32 @@
 enum {
     vialrgb_set_mode = 0x41,
     vialrgb_direct_fastset = 0x42,
+    vialrgb_direct_stream = 0x43,
+    vialrgb_direct_set_palette = 0x44,
+    vialrgb_direct_present = 0x45,
 };
 
+/* Pixel encodings accepted by vialrgb_direct_stream */
+enum {
+    vialrgb_direct_rgb888 = 0x00,
+    vialrgb_direct_rgb565 = 0x01,
+    vialrgb_direct_rle565 = 0x02,
+    vialrgb_direct_palette4 = 0x03,
+};
+
+/* Capability flags reported by vialrgb_get_info */
+#define VIALRGB_CAP_DIRECT_STREAM (1 << 0)
+#define VIALRGB_CAP_RENDER_STATS (1 << 1)
+
+#define VIALRGB_PALETTE_SIZE 16
+
 enum {
     vialrgb_get_info = 0x40,
     vialrgb_get_mode = 0x41,
     vialrgb_get_supported = 0x42,
     vialrgb_get_number_leds = 0x43,
     vialrgb_get_led_info = 0x44,
+    vialrgb_get_render_stats = 0x45,
 };
 
 void vialrgb_get_value(uint8_t *data, uint8_t length);
@@ -63,4 +63,31 @@ wear_leveling_8byte_SRC := \
 	$(wear_leveling_common_SRC) \
 	$(QUANTUM_PATH)/wear_leveling/tests/wear_leveling_8byte.cpp
 wear_leveling_8byte_INC := \
-	$(wear_leveling_common_INC)
\ No newline at end of file
+	$(wear_leveling_common_INC)
+wear_leveling_deferred_DEFS := \
+	$(wear_leveling_common_DEFS) \
+	-DBACKING_STORE_WRITE_SIZE=2 \
+	-DWEAR_LEVELING_BACKING_SIZE=128 \
+	-DWEAR_LEVELING_LOGICAL_SIZE=32 \
+	-DWEAR_LEVELING_DEFERRED_CONSOLIDATION \
+	-DWEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE=8
+wear_leveling_deferred_SRC := \
+	$(wear_leveling_common_SRC) \
+	$(QUANTUM_PATH)/wear_leveling/tests/wear_leveling_deferred.cpp
+wear_leveling_deferred_INC := \
+	$(wear_leveling_common_INC)
+
+wear_leveling_coalescing_DEFS := \
+	$(wear_leveling_common_DEFS) \
+	-DBACKING_STORE_WRITE_SIZE=2 \
+	-DWEAR_LEVELING_BACKING_SIZE=4096 \
+	-DWEAR_LEVELING_LOGICAL_SIZE=1024 \
+	-DWEAR_LEVELING_WRITE_COALESCING \
+	-DWEAR_LEVELING_COALESCING_IDLE_MS=100 \
+	-DWEAR_LEVELING_STATS
+wear_leveling_coalescing_SRC := \
+	$(wear_leveling_common_SRC) \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c \
+	$(QUANTUM_PATH)/wear_leveling/tests/wear_leveling_coalescing.cpp
+wear_leveling_coalescing_INC := \
+	$(wear_leveling_common_INC)
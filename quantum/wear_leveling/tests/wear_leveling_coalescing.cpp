@@ -0,0 +1,171 @@
+// Copyright 2022 Nick Brassel (@tzarc)
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <iostream>
+#include <numeric>
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "backing_mocks.hpp"
+
+extern "C" {
+#include "timer.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class WearLevelingCoalescing : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        MockBackingStore::Instance().reset_instance();
+        set_time(0);
+        wear_leveling_init();
+        wear_leveling_reset_stats();
+    }
+};
+
+static void verify_after_init(uint32_t address, const uint8_t* expected, size_t length) {
+    std::vector<std::uint8_t> readback(length);
+    EXPECT_EQ(wear_leveling_init(), WEAR_LEVELING_SUCCESS) << "Init returned incorrect status";
+    EXPECT_EQ(wear_leveling_read(address, readback.data(), length), WEAR_LEVELING_SUCCESS) << "Failed to read";
+    for (size_t i = 0; i < length; ++i) {
+        EXPECT_EQ(readback[i], expected[i]) << "Readback mismatch at index " << i;
+    }
+}
+
+/**
+ * This test verifies that writes are only held in the cache until they are flushed.
+ */
+TEST_F(WearLevelingCoalescing, WritesHeldUntilFlush) {
+    auto&   inst  = MockBackingStore::Instance();
+    uint8_t value = 0x42;
+
+    EXPECT_EQ(wear_leveling_write(0x100, &value, sizeof(value)), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    EXPECT_EQ(inst.write_invoke_count(), 0) << "Write should not have reached the backing store";
+    EXPECT_TRUE(wear_leveling_flush_pending()) << "Write should be pending";
+
+    uint8_t readback = 0;
+    EXPECT_EQ(wear_leveling_read(0x100, &readback, sizeof(readback)), WEAR_LEVELING_SUCCESS) << "Failed to read";
+    EXPECT_EQ(readback, value) << "Pending write should be readable";
+
+    EXPECT_EQ(wear_leveling_flush(), WEAR_LEVELING_SUCCESS) << "Flush returned incorrect status";
+    EXPECT_FALSE(wear_leveling_flush_pending()) << "Nothing should be pending after flush";
+    EXPECT_GT(inst.write_invoke_count(), 0) << "Flush should have written to the backing store";
+
+    verify_after_init(0x100, &value, sizeof(value));
+}
+
+/**
+ * This test verifies that pending writes are flushed by the task once writes have been idle long enough.
+ */
+TEST_F(WearLevelingCoalescing, IdleFlush) {
+    auto&   inst  = MockBackingStore::Instance();
+    uint8_t value = 0x42;
+
+    EXPECT_EQ(wear_leveling_write(0x100, &value, sizeof(value)), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    advance_time(WEAR_LEVELING_COALESCING_IDLE_MS - 1);
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Task returned incorrect status";
+    EXPECT_EQ(inst.write_invoke_count(), 0) << "Task should not have flushed before the idle period";
+
+    advance_time(1);
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Task returned incorrect status";
+    EXPECT_FALSE(wear_leveling_flush_pending()) << "Task should have flushed after the idle period";
+
+    verify_after_init(0x100, &value, sizeof(value));
+}
+
+/**
+ * This test verifies that a burst of adjacent single-byte writes ends up as multi-byte log entries, comparing against
+ * the same writes flushed individually.
+ */
+TEST_F(WearLevelingCoalescing, Burst_FewerLogEntries) {
+    const uint32_t                 base = 0x100;
+    std::array<std::uint8_t, 100> data;
+    std::iota(data.begin(), data.end(), 0x20);
+
+    // Each byte flushed on its own, as if coalescing was disabled
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(wear_leveling_write(base + i, &data[i], 1), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+        EXPECT_EQ(wear_leveling_flush(), WEAR_LEVELING_SUCCESS) << "Flush returned incorrect status";
+    }
+    wear_leveling_stats_t individual;
+    wear_leveling_get_stats(&individual);
+
+    MockBackingStore::Instance().reset_instance();
+    wear_leveling_init();
+    wear_leveling_reset_stats();
+
+    // The same bytes, coalesced
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(wear_leveling_write(base + i, &data[i], 1), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    }
+    EXPECT_EQ(wear_leveling_flush(), WEAR_LEVELING_SUCCESS) << "Flush returned incorrect status";
+    wear_leveling_stats_t coalesced;
+    wear_leveling_get_stats(&coalesced);
+
+    EXPECT_EQ(individual.logical_bytes, data.size());
+    EXPECT_EQ(coalesced.logical_bytes, data.size());
+    EXPECT_EQ(individual.log_entries, data.size()) << "Expected one log entry per byte";
+    EXPECT_EQ(coalesced.log_entries, data.size() / LOG_ENTRY_MULTIBYTE_MAX_BYTES) << "Expected fully packed log entries";
+    EXPECT_LT(coalesced.backing_writes, individual.backing_writes);
+
+    std::cout << "[  STATS   ] individual: " << (double)individual.log_entries / individual.logical_bytes << " log entries/byte, " << (double)individual.backing_writes / individual.logical_bytes << " backing writes/byte" << std::endl;
+    std::cout << "[  STATS   ] coalesced:  " << (double)coalesced.log_entries / coalesced.logical_bytes << " log entries/byte, " << (double)coalesced.backing_writes / coalesced.logical_bytes << " backing writes/byte" << std::endl;
+
+    verify_after_init(base, data.data(), data.size());
+}
+
+/**
+ * This test verifies that overlapping and adjacent writes are merged, including ranges bridged by a later write.
+ */
+TEST_F(WearLevelingCoalescing, RangesMerged) {
+    uint8_t a[2] = {0x11, 0x12};
+    uint8_t b[2] = {0x21, 0x22};
+    uint8_t c[2] = {0x31, 0x32};
+
+    EXPECT_EQ(wear_leveling_write(0x200, a, sizeof(a)), WEAR_LEVELING_SUCCESS);
+    EXPECT_EQ(wear_leveling_write(0x204, c, sizeof(c)), WEAR_LEVELING_SUCCESS);
+    EXPECT_EQ(wear_leveling_write(0x202, b, sizeof(b)), WEAR_LEVELING_SUCCESS); // bridges the two ranges above
+    EXPECT_EQ(wear_leveling_flush(), WEAR_LEVELING_SUCCESS);
+
+    wear_leveling_stats_t stats;
+    wear_leveling_get_stats(&stats);
+    EXPECT_EQ(stats.log_entries, 2) << "6 contiguous bytes should need 2 log entries";
+
+    uint8_t expected[6] = {0x11, 0x12, 0x21, 0x22, 0x31, 0x32};
+    verify_after_init(0x200, expected, sizeof(expected));
+}
+
+/**
+ * This test verifies that running out of range slots forces a flush rather than losing data.
+ */
+TEST_F(WearLevelingCoalescing, RangesExhausted_Flushes) {
+    auto&   inst  = MockBackingStore::Instance();
+    uint8_t value = 0x55;
+
+    for (int i = 0; i < WEAR_LEVELING_COALESCING_RANGES; ++i) {
+        EXPECT_EQ(wear_leveling_write(0x100 + i * 0x10, &value, sizeof(value)), WEAR_LEVELING_SUCCESS);
+    }
+    EXPECT_EQ(inst.write_invoke_count(), 0) << "No flush should have occurred yet";
+
+    EXPECT_EQ(wear_leveling_write(0x300, &value, sizeof(value)), WEAR_LEVELING_SUCCESS);
+    EXPECT_GT(inst.write_invoke_count(), 0) << "Range slots exhausted, flush should have occurred";
+    EXPECT_TRUE(wear_leveling_flush_pending()) << "Latest write should still be pending";
+
+    EXPECT_EQ(wear_leveling_flush(), WEAR_LEVELING_SUCCESS);
+    for (int i = 0; i < WEAR_LEVELING_COALESCING_RANGES; ++i) {
+        verify_after_init(0x100 + i * 0x10, &value, sizeof(value));
+    }
+    verify_after_init(0x300, &value, sizeof(value));
+}
+
+/**
+ * This test verifies that erasing discards pending writes.
+ */
+TEST_F(WearLevelingCoalescing, Erase_DiscardsPending) {
+    uint8_t value = 0x42;
+    EXPECT_EQ(wear_leveling_write(0x100, &value, sizeof(value)), WEAR_LEVELING_SUCCESS);
+    EXPECT_EQ(wear_leveling_erase(), WEAR_LEVELING_SUCCESS);
+    EXPECT_FALSE(wear_leveling_flush_pending()) << "Erase should have discarded pending writes";
+
+    uint8_t zero = 0;
+    verify_after_init(0x100, &zero, sizeof(zero));
+}
@@ -0,0 +1,189 @@
+// Copyright 2022 Nick Brassel (@tzarc)
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <numeric>
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "backing_mocks.hpp"
+
+class WearLevelingDeferred : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        MockBackingStore::Instance().reset_instance();
+        wear_leveling_init();
+        verify_data.fill(0);
+    }
+
+    static std::array<std::uint8_t, WEAR_LEVELING_LOGICAL_SIZE> verify_data;
+};
+
+std::array<std::uint8_t, WEAR_LEVELING_LOGICAL_SIZE> WearLevelingDeferred::verify_data;
+
+static wear_leveling_status_t test_write(std::array<std::uint8_t, WEAR_LEVELING_LOGICAL_SIZE>& verify, const uint32_t address, uint8_t value) {
+    verify[address] = value;
+    return wear_leveling_write(address, &value, sizeof(value));
+}
+
+static void verify_after_init(const std::array<std::uint8_t, WEAR_LEVELING_LOGICAL_SIZE>& verify) {
+    std::array<std::uint8_t, WEAR_LEVELING_LOGICAL_SIZE> readback;
+    EXPECT_EQ(wear_leveling_init(), WEAR_LEVELING_SUCCESS) << "Init returned incorrect status";
+    EXPECT_EQ(wear_leveling_read(0, readback.data(), readback.size()), WEAR_LEVELING_SUCCESS) << "Failed to read";
+    for (int i = 0; i < WEAR_LEVELING_LOGICAL_SIZE; ++i) {
+        EXPECT_EQ(readback[i], verify[i]) << "Readback mismatch at index " << i;
+    }
+}
+
+/**
+ * Fills the write log up to the consolidation reserve, which should schedule a consolidation without performing it.
+ */
+static void fill_to_reserve(std::array<std::uint8_t, WEAR_LEVELING_LOGICAL_SIZE>& verify) {
+    auto& inst = MockBackingStore::Instance();
+    // All writes are at address<64, so each logical byte written generates a single backing store write
+    for (int i = 0; !wear_leveling_consolidation_pending(); ++i) {
+        ASSERT_LT(i, WEAR_LEVELING_BACKING_SIZE) << "Consolidation was never scheduled";
+        EXPECT_EQ(test_write(verify, i % WEAR_LEVELING_LOGICAL_SIZE, (uint8_t)(i + 1)), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    }
+    EXPECT_EQ(inst.erase_invoke_count(), 0) << "Backing store should not have been erased yet";
+}
+
+/**
+ * This test verifies that reaching the write log reserve only schedules consolidation, and that the write log keeps
+ * accepting writes afterwards.
+ */
+TEST_F(WearLevelingDeferred, ReserveReached_ConsolidationScheduled) {
+    auto& inst = MockBackingStore::Instance();
+    EXPECT_FALSE(wear_leveling_consolidation_pending()) << "Consolidation should not be pending after init";
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Idle task returned incorrect status";
+    EXPECT_EQ(inst.erase_invoke_count(), 0) << "Idle task should not erase";
+
+    fill_to_reserve(verify_data);
+
+    uint64_t write_count = inst.write_invoke_count();
+    EXPECT_EQ(test_write(verify_data, 0x05, 0xA5), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    EXPECT_EQ(inst.write_invoke_count(), write_count + 1) << "Write should have been appended to the reserve";
+    EXPECT_EQ(inst.erase_invoke_count(), 0) << "Backing store should not have been erased yet";
+
+    verify_after_init(verify_data);
+}
+
+/**
+ * Runs the task until the pending consolidation completes.
+ */
+static void run_consolidation(void) {
+    for (int i = 0; wear_leveling_consolidation_pending(); ++i) {
+        ASSERT_LT(i, WEAR_LEVELING_BACKING_SIZE) << "Consolidation never completed";
+        EXPECT_NE(wear_leveling_task(), WEAR_LEVELING_FAILED) << "Task failed";
+    }
+}
+
+/**
+ * This test verifies that a scheduled consolidation is carried out one chunk at a time, and that the write log is
+ * left intact until the erase step.
+ */
+TEST_F(WearLevelingDeferred, Task_ConsolidatesInChunks) {
+    auto& inst = MockBackingStore::Instance();
+    fill_to_reserve(verify_data);
+
+    // Everything written so far can still be recovered from the write log
+    verify_after_init(verify_data);
+    EXPECT_TRUE(wear_leveling_consolidation_pending()) << "Consolidation should still be pending after init";
+
+    // First step erases
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Erase step returned incorrect status";
+    EXPECT_EQ(inst.erase_invoke_count(), 1) << "Erase step should have erased the backing store";
+    EXPECT_TRUE(wear_leveling_consolidation_pending()) << "Consolidation should still be in progress";
+
+    // Each following step writes one chunk, the last one also writes the checksum
+    const int chunks = WEAR_LEVELING_LOGICAL_SIZE / WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE;
+    for (int i = 0; i < chunks; ++i) {
+        uint64_t write_count = inst.write_invoke_count();
+        auto     status      = wear_leveling_task();
+        if (i < chunks - 1) {
+            EXPECT_EQ(status, WEAR_LEVELING_SUCCESS) << "Chunk step returned incorrect status";
+            EXPECT_EQ(inst.write_invoke_count(), write_count + WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE / BACKING_STORE_WRITE_SIZE) << "Chunk step wrote incorrect amount";
+        } else {
+            EXPECT_EQ(status, WEAR_LEVELING_CONSOLIDATED) << "Final step returned incorrect status";
+        }
+    }
+    EXPECT_FALSE(wear_leveling_consolidation_pending()) << "Consolidation should have completed";
+    EXPECT_EQ(inst.erase_invoke_count(), 1) << "Only a single erase should have occurred";
+    EXPECT_EQ(inst.lock_invoke_count(), inst.unlock_invoke_count()) << "Lock/unlock mismatch";
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Idle task returned incorrect status";
+
+    verify_after_init(verify_data);
+
+    // Next write goes to the start of the write log
+    EXPECT_EQ(test_write(verify_data, 0x02, 0x5A), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    EXPECT_EQ((inst.log_end() - 1)->address, WEAR_LEVELING_LOGICAL_SIZE + 8) << "Invalid first write address.";
+}
+
+/**
+ * This test verifies that writes received while consolidated data is being written are not lost, regardless of
+ * whether their chunk had already been written.
+ */
+TEST_F(WearLevelingDeferred, WriteDuringConsolidation_Preserved) {
+    auto& inst = MockBackingStore::Instance();
+    fill_to_reserve(verify_data);
+
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Erase step returned incorrect status";
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "First chunk step returned incorrect status";
+
+    // One write into the chunk already written, one into a chunk yet to be written, both go to the new write log
+    EXPECT_EQ(test_write(verify_data, 0x01, 0xAA), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    EXPECT_EQ((inst.log_end() - 1)->address, WEAR_LEVELING_LOGICAL_SIZE + 8) << "Write should have started the new write log";
+    EXPECT_EQ(test_write(verify_data, WEAR_LEVELING_LOGICAL_SIZE - 1, 0xBB), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+
+    run_consolidation();
+    EXPECT_EQ(inst.erase_invoke_count(), 1) << "Only a single erase should have occurred";
+
+    verify_after_init(verify_data);
+}
+
+/**
+ * This test verifies that if the reserve runs out before the task gets to run, consolidation occurs in-line.
+ */
+TEST_F(WearLevelingDeferred, ReserveExhausted_ConsolidatesInline) {
+    auto& inst = MockBackingStore::Instance();
+    fill_to_reserve(verify_data);
+
+    wear_leveling_status_t status = WEAR_LEVELING_SUCCESS;
+    for (int i = 0; status == WEAR_LEVELING_SUCCESS; ++i) {
+        ASSERT_LT(i, WEAR_LEVELING_BACKING_SIZE) << "Consolidation never occurred";
+        status = test_write(verify_data, i % WEAR_LEVELING_LOGICAL_SIZE, (uint8_t)(0x80 + i));
+    }
+    EXPECT_EQ(status, WEAR_LEVELING_CONSOLIDATED) << "Write returned incorrect status";
+    EXPECT_EQ(inst.erase_invoke_count(), 1) << "In-line consolidation should have erased the backing store";
+    EXPECT_FALSE(wear_leveling_consolidation_pending()) << "Consolidation should no longer be pending";
+
+    verify_after_init(verify_data);
+}
+
+/**
+ * This test verifies that a failed consolidation is reported and not retried on every task call.
+ */
+TEST_F(WearLevelingDeferred, WriteFailure_ReportsFailure) {
+    auto& inst = MockBackingStore::Instance();
+    fill_to_reserve(verify_data);
+
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Erase step returned incorrect status";
+
+    inst.set_write_callback([](std::uint64_t count, std::uint32_t address) { return false; });
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_FAILED) << "Chunk step should have failed";
+    inst.set_write_callback([](std::uint64_t count, std::uint32_t address) { return true; });
+
+    EXPECT_FALSE(wear_leveling_consolidation_pending()) << "Consolidation should have been abandoned";
+    EXPECT_EQ(test_write(verify_data, 0x03, 0x33), WEAR_LEVELING_SUCCESS) << "Write returned incorrect status";
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Idle task returned incorrect status";
+}
+
+/**
+ * This test verifies that erasing cancels any pending consolidation.
+ */
+TEST_F(WearLevelingDeferred, Erase_CancelsConsolidation) {
+    auto& inst = MockBackingStore::Instance();
+    fill_to_reserve(verify_data);
+
+    EXPECT_EQ(wear_leveling_erase(), WEAR_LEVELING_SUCCESS) << "Erase returned incorrect status";
+    EXPECT_FALSE(wear_leveling_consolidation_pending()) << "Consolidation should have been cancelled";
+    EXPECT_EQ(wear_leveling_task(), WEAR_LEVELING_SUCCESS) << "Idle task returned incorrect status";
+    EXPECT_EQ(inst.erase_invoke_count(), 1) << "Only the explicit erase should have occurred";
+}
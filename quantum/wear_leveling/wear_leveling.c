@@ -4,6 +4,9 @@
 #include "fnv.h"
 #include "wear_leveling.h"
 #include "wear_leveling_internal.h"
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+#    include "timer.h"
+#endif // WEAR_LEVELING_WRITE_COALESCING
 
 /*
     This wear leveling algorithm is adapted from algorithms from previous
@@ -61,6 +64,34 @@
             to other subsystems performing reads/writes. This must be a multiple
             of the write size.
 
+        - WEAR_LEVELING_DEFERRED_CONSOLIDATION: If defined, consolidation is
+            no longer performed in-line when the write log fills up, but
+            scheduled and carried out in steps by wear_leveling_task().
+
+        - WEAR_LEVELING_CONSOLIDATION_RESERVE: The number of bytes at the end
+            of the write log kept free for writes that occur while a deferred
+            consolidation is pending. Defaults to a quarter of the write log.
+
+        - WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE: The number of bytes of
+            consolidated data written by each wear_leveling_task() step. This
+            must be a multiple of the write size.
+
+        - WEAR_LEVELING_WRITE_COALESCING: If defined, writes only update the
+            cache and remember the modified range; overlapping and adjacent
+            ranges are merged and written to the log once writes have been
+            idle for WEAR_LEVELING_COALESCING_IDLE_MS, or on an explicit
+            wear_leveling_flush().
+
+        - WEAR_LEVELING_COALESCING_RANGES: The number of distinct modified
+            ranges tracked before a flush is forced.
+
+        - WEAR_LEVELING_COALESCING_IDLE_MS: The number of milliseconds without
+            writes after which wear_leveling_task() flushes pending ranges.
+
+        - WEAR_LEVELING_STATS: If defined, counts of logical bytes written,
+            write log entries and backing store writes are kept, see
+            wear_leveling_get_stats().
+
     General algorithm:
 
         During initialization:
@@ -76,6 +107,36 @@
             * A new write log entry is appended to the log.
             * If the log's full, data is consolidated and the write log cleared.
 
+    Deferred consolidation:
+
+        With WEAR_LEVELING_DEFERRED_CONSOLIDATION, reaching the reserve at the
+        end of the write log only marks consolidation as pending, and further
+        writes keep being appended into the reserve. Each wear_leveling_task()
+        call then performs one step:
+            * Pending: the backing store is erased.
+            * Writing: the next chunk of the cache is written to the
+                consolidated data area, accumulating the FNV1a_64 as it goes.
+                Once all chunks are written the checksum is written.
+        The write log lives after the checksum, so writes received while
+        consolidated data is being written are appended to the new log as
+        usual -- whether or not their chunk was already written, playback
+        leaves the cache with the latest value.
+        If the reserve fills up before the task gets to run, consolidation
+        falls back to being performed in-line.
+        The backing store can only be erased as a whole, so -- as with in-line
+        consolidation -- a power loss between the erase and the checksum being
+        written loses the consolidated data. With the steps spread over
+        several task calls, that window lasts a few main loop passes rather
+        than a single call.
+
+    Write coalescing:
+
+        With WEAR_LEVELING_WRITE_COALESCING, bursts of small writes -- such as
+        a keymap being pushed one byte at a time -- are merged in RAM and
+        written as a few multi-byte log entries instead of one entry each.
+        Anything written since the last flush is lost on power loss, so
+        wear_leveling_flush() is also invoked before a reset.
+
     Write log structure:
 
         The first 8 bytes of the write log are a FNV1a_64 hash of the contents
@@ -155,6 +216,17 @@
         ╚════════════════╝
         0 <= Address <= 0x3FFE (16382) */
 
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+/**
+ * Deferred consolidation state.
+ */
+typedef enum wear_leveling_consolidation_state_t {
+    CONSOLIDATION_IDLE = 0, //< Nothing to do
+    CONSOLIDATION_PENDING,  //< Write log reserve reached, backing store needs erasing
+    CONSOLIDATION_WRITING   //< Backing store erased, consolidated data is being written
+} wear_leveling_consolidation_state_t;
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
 /**
  * Storage area for the wear-leveling cache.
  */
@@ -162,8 +234,34 @@ static struct __attribute__((__aligned__(BACKING_STORE_WRITE_SIZE))) {
     __attribute__((__aligned__(BACKING_STORE_WRITE_SIZE))) uint8_t cache[(WEAR_LEVELING_LOGICAL_SIZE)];
     uint32_t                                                       write_address;
     bool                                                           unlocked;
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+    struct {
+        wear_leveling_consolidation_state_t state;
+        uint32_t                            offset;   // Next chunk of consolidated data to write
+        uint64_t                            checksum; // FNV1a_64 of the consolidated data written so far
+    } consolidation;
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+    struct {
+        uint32_t start;
+        uint32_t end;
+    } pending[(WEAR_LEVELING_COALESCING_RANGES)];
+    uint8_t  pending_count;
+    uint32_t last_write;
+#endif // WEAR_LEVELING_WRITE_COALESCING
+#ifdef WEAR_LEVELING_STATS
+    wear_leveling_stats_t stats;
+#endif // WEAR_LEVELING_STATS
 } wear_leveling;
 
+#ifdef WEAR_LEVELING_STATS
+#    define wl_stats_add(field, count) (wear_leveling.stats.field += (count))
+#else
+#    define wl_stats_add(field, count) \
+        do {                           \
+        } while (0)
+#endif // WEAR_LEVELING_STATS
+
 /**
  * Locking helper: status
  */
@@ -203,6 +301,12 @@ static inline backing_store_lock_status_t wear_leveling_lock(void) {
 static void wear_leveling_clear_cache(void) {
     memset(wear_leveling.cache, 0, (WEAR_LEVELING_LOGICAL_SIZE));
     wear_leveling.write_address = (WEAR_LEVELING_LOGICAL_SIZE) + 8; // +8 is due to the FNV1a_64 of the consolidated buffer
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+    wear_leveling.consolidation.state = CONSOLIDATION_IDLE;
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+    wear_leveling.pending_count = 0;
+#endif // WEAR_LEVELING_WRITE_COALESCING
 }
 
 /**
@@ -248,6 +352,23 @@ static wear_leveling_status_t wear_leveling_read_consolidated(void) {
     return status;
 }
 
+/**
+ * Writes the FNV1a_64 of the consolidated data after the consolidated data area.
+ * Pre-condition: the backing store is unlocked.
+ */
+static bool wear_leveling_write_checksum(uint64_t checksum) {
+    write_log_entry_t entry;
+    entry.raw64 = checksum;
+    wl_dprintf("Writing checksum\n");
+#if BACKING_STORE_WRITE_SIZE == 2
+    return backing_store_write_bulk((WEAR_LEVELING_LOGICAL_SIZE), entry.raw16, 4);
+#elif BACKING_STORE_WRITE_SIZE == 4
+    return backing_store_write_bulk((WEAR_LEVELING_LOGICAL_SIZE), entry.raw32, 2);
+#elif BACKING_STORE_WRITE_SIZE == 8
+    return backing_store_write((WEAR_LEVELING_LOGICAL_SIZE), entry.raw64);
+#endif
+}
+
 /**
  * Writes the current cache to consolidated data at the beginning of the backing store.
  * Does not clear the write log.
@@ -265,27 +386,9 @@ static wear_leveling_status_t wear_leveling_write_consolidated(void) {
 
     if (status != WEAR_LEVELING_FAILED) {
         // Write out the FNV1a_64 result of the consolidated data
-        write_log_entry_t entry;
-        entry.raw64 = fnv_64a_buf(wear_leveling.cache, (WEAR_LEVELING_LOGICAL_SIZE), FNV1A_64_INIT);
-        wl_dprintf("Writing checksum\n");
-        do {
-#if BACKING_STORE_WRITE_SIZE == 2
-            if (!backing_store_write_bulk((WEAR_LEVELING_LOGICAL_SIZE), entry.raw16, 4)) {
-                status = WEAR_LEVELING_FAILED;
-                break;
-            }
-#elif BACKING_STORE_WRITE_SIZE == 4
-            if (!backing_store_write_bulk((WEAR_LEVELING_LOGICAL_SIZE), entry.raw32, 2)) {
-                status = WEAR_LEVELING_FAILED;
-                break;
-            }
-#elif BACKING_STORE_WRITE_SIZE == 8
-            if (!backing_store_write((WEAR_LEVELING_LOGICAL_SIZE), entry.raw64)) {
-                status = WEAR_LEVELING_FAILED;
-                break;
-            }
-#endif
-        } while (0);
+        if (!wear_leveling_write_checksum(fnv_64a_buf(wear_leveling.cache, (WEAR_LEVELING_LOGICAL_SIZE), FNV1A_64_INIT))) {
+            status = WEAR_LEVELING_FAILED;
+        }
     }
 
     if (lock_status == STATUS_SUCCESS) {
@@ -317,6 +420,13 @@ static wear_leveling_status_t wear_leveling_consolidate_force(void) {
 
     // Next write of the log occurs after the consolidated values at the start of the backing store.
     wear_leveling.write_address = (WEAR_LEVELING_LOGICAL_SIZE) + 8; // +8 due to the FNV1a_64 of the consolidated area
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+    wear_leveling.consolidation.state = CONSOLIDATION_IDLE;
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+    // The whole cache has just been written, including anything not yet flushed.
+    wear_leveling.pending_count = 0;
+#endif // WEAR_LEVELING_WRITE_COALESCING
 
     return status;
 }
@@ -333,6 +443,14 @@ static wear_leveling_status_t wear_leveling_consolidate_if_needed(void) {
         return wear_leveling_consolidate_force();
     }
 
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+    // Leave the actual consolidation to wear_leveling_task(), the reserve at the end of the log keeps taking writes until then.
+    if (wear_leveling.write_address >= (WEAR_LEVELING_BACKING_SIZE) - (WEAR_LEVELING_CONSOLIDATION_RESERVE) && wear_leveling.consolidation.state == CONSOLIDATION_IDLE) {
+        wl_dprintf("Write log reserve reached, scheduling consolidation\n");
+        wear_leveling.consolidation.state = CONSOLIDATION_PENDING;
+    }
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
     return WEAR_LEVELING_SUCCESS;
 }
 
@@ -348,6 +466,7 @@ static wear_leveling_status_t wear_leveling_append_raw(backing_store_int_t value
         return WEAR_LEVELING_FAILED;
     }
     wear_leveling.write_address += (BACKING_STORE_WRITE_SIZE);
+    wl_stats_add(backing_writes, 1);
     return wear_leveling_consolidate_if_needed();
 }
 
@@ -365,6 +484,7 @@ static wear_leveling_status_t wear_leveling_write_raw_multibyte(uint32_t address
 
     // Write to the backing store. See the multi-byte log format in the documentation header at the top of the file.
     wear_leveling_status_t status;
+    wl_stats_add(log_entries, 1);
 #if BACKING_STORE_WRITE_SIZE == 2
     status = wear_leveling_append_raw(log.raw16[0]);
     if (status != WEAR_LEVELING_SUCCESS) {
@@ -424,7 +544,8 @@ static wear_leveling_status_t wear_leveling_write_raw(uint32_t address, const vo
             const uint16_t v = ((uint16_t)p[1]) << 8 | p[0]; // don't just dereference a uint16_t here -- if unaligned it generates faults on some MCUs
             if (v == 0 || v == 1) {
                 const write_log_entry_t log = LOG_ENTRY_MAKE_WORD_01(address, v);
-                status                      = wear_leveling_append_raw(log.raw16[0]);
+                wl_stats_add(log_entries, 1);
+                status = wear_leveling_append_raw(log.raw16[0]);
                 if (status != WEAR_LEVELING_SUCCESS) {
                     // If consolidation occurred, then the cache has already been written to the consolidated area. No need to continue.
                     // If a failure occurred, pass it on.
@@ -441,7 +562,8 @@ static wear_leveling_status_t wear_leveling_write_raw(uint32_t address, const vo
         // Small-write optimizations - address<64:
         if (address < 64) {
             const write_log_entry_t log = LOG_ENTRY_MAKE_OPTIMIZED_64(address, *p);
-            status                      = wear_leveling_append_raw(log.raw16[0]);
+            wl_stats_add(log_entries, 1);
+            status = wear_leveling_append_raw(log.raw16[0]);
             if (status != WEAR_LEVELING_SUCCESS) {
                 // If consolidation occurred, then the cache has already been written to the consolidated area. No need to continue.
                 // If a failure occurred, pass it on.
@@ -671,6 +793,72 @@ wear_leveling_status_t wear_leveling_erase(void) {
     return ret ? WEAR_LEVELING_SUCCESS : WEAR_LEVELING_FAILED;
 }
 
+static wear_leveling_status_t wear_leveling_write_logged(const uint32_t address, size_t length);
+
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+/**
+ * Records a modified range of the cache, merging it with any overlapping or adjacent ranges already pending.
+ */
+static wear_leveling_status_t wear_leveling_coalesce(uint32_t address, size_t length) {
+    wear_leveling.last_write = timer_read32();
+
+    uint32_t start = address;
+    uint32_t end   = address + (uint32_t)length;
+    for (uint8_t i = 0; i < wear_leveling.pending_count;) {
+        if (start <= wear_leveling.pending[i].end && end >= wear_leveling.pending[i].start) {
+            // Absorb this range and remove it from the list, the merged range may now touch others
+            if (wear_leveling.pending[i].start < start) {
+                start = wear_leveling.pending[i].start;
+            }
+            if (wear_leveling.pending[i].end > end) {
+                end = wear_leveling.pending[i].end;
+            }
+            wear_leveling.pending[i] = wear_leveling.pending[--wear_leveling.pending_count];
+            continue;
+        }
+        ++i;
+    }
+
+    wear_leveling_status_t status = WEAR_LEVELING_SUCCESS;
+    if (wear_leveling.pending_count >= (WEAR_LEVELING_COALESCING_RANGES)) {
+        status = wear_leveling_flush();
+        if (status == WEAR_LEVELING_FAILED) {
+            return status;
+        }
+    }
+
+    wear_leveling.pending[wear_leveling.pending_count].start = start;
+    wear_leveling.pending[wear_leveling.pending_count].end   = end;
+    ++wear_leveling.pending_count;
+    return status;
+}
+
+/**
+ * Writes all pending ranges to the write log.
+ */
+wear_leveling_status_t wear_leveling_flush(void) {
+    wear_leveling_status_t status = WEAR_LEVELING_SUCCESS;
+    while (wear_leveling.pending_count > 0) {
+        uint8_t i = --wear_leveling.pending_count;
+        status    = wear_leveling_write_logged(wear_leveling.pending[i].start, wear_leveling.pending[i].end - wear_leveling.pending[i].start);
+        if (status != WEAR_LEVELING_SUCCESS) {
+            // Consolidation writes the whole cache, so nothing remains pending.
+            // On failure, give up on the remaining ranges rather than retrying forever.
+            wear_leveling.pending_count = 0;
+            break;
+        }
+    }
+    return status;
+}
+
+/**
+ * Whether there are writes yet to be flushed to the write log.
+ */
+bool wear_leveling_flush_pending(void) {
+    return wear_leveling.pending_count > 0;
+}
+#endif // WEAR_LEVELING_WRITE_COALESCING
+
 /**
  * Writes logical data into the backing store. Skips writes if there are no changes to values.
  */
@@ -691,6 +879,20 @@ wear_leveling_status_t wear_leveling_write(const uint32_t address, const void *v
     // Update the cache before writing to the backing store -- if we hit the end of the backing store during writes to the log then we'll force a consolidation in-line
     memcpy(&wear_leveling.cache[address], value, length);
 
+    wl_stats_add(logical_bytes, length);
+
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+    // Leave it to wear_leveling_flush() to write the merged ranges to the log
+    return wear_leveling_coalesce(address, length);
+#else
+    return wear_leveling_write_logged(address, length);
+#endif // WEAR_LEVELING_WRITE_COALESCING
+}
+
+/**
+ * Appends the given range of the cache to the write log, consolidating if required.
+ */
+static wear_leveling_status_t wear_leveling_write_logged(const uint32_t address, size_t length) {
     // Unlock the backing store
     backing_store_lock_status_t lock_status = wear_leveling_unlock();
     if (lock_status == STATUS_FAILURE) {
@@ -699,7 +901,7 @@ wear_leveling_status_t wear_leveling_write(const uint32_t address, const void *v
     }
 
     // Perform the actual write
-    wear_leveling_status_t status = wear_leveling_write_raw(address, value, length);
+    wear_leveling_status_t status = wear_leveling_write_raw(address, &wear_leveling.cache[address], length);
     switch (status) {
         case WEAR_LEVELING_CONSOLIDATED:
         case WEAR_LEVELING_FAILED:
@@ -726,6 +928,102 @@ wear_leveling_status_t wear_leveling_write(const uint32_t address, const void *v
     return status;
 }
 
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+/**
+ * Performs the next step of a deferred consolidation: either the erase, or writing one chunk of consolidated data.
+ * Pre-condition: the backing store is unlocked.
+ */
+static wear_leveling_status_t wear_leveling_consolidate_step(void) {
+    if (wear_leveling.consolidation.state == CONSOLIDATION_PENDING) {
+        wl_dprintf("Erasing backing store\n");
+        if (!backing_store_erase()) {
+            wl_dprintf("Failed to erase backing store\n");
+            wear_leveling.consolidation.state = CONSOLIDATION_IDLE;
+            return WEAR_LEVELING_FAILED;
+        }
+
+        // The old write log is gone, new writes go to the start of the new one
+        wear_leveling.write_address          = (WEAR_LEVELING_LOGICAL_SIZE) + 8; // +8 due to the FNV1a_64 of the consolidated area
+        wear_leveling.consolidation.state    = CONSOLIDATION_WRITING;
+        wear_leveling.consolidation.offset   = 0;
+        wear_leveling.consolidation.checksum = FNV1A_64_INIT;
+        return WEAR_LEVELING_SUCCESS;
+    }
+
+    uint32_t offset = wear_leveling.consolidation.offset;
+    uint32_t length = (WEAR_LEVELING_LOGICAL_SIZE) - offset;
+    if (length > (WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE)) {
+        length = (WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE);
+    }
+
+    wl_dprintf("Writing consolidated data at 0x%04X\n", (int)offset);
+    if (!backing_store_write_bulk(offset, (backing_store_int_t *)&wear_leveling.cache[offset], length / sizeof(backing_store_int_t))) {
+        wl_dprintf("Failed to write to backing store\n");
+        wear_leveling.consolidation.state = CONSOLIDATION_IDLE;
+        return WEAR_LEVELING_FAILED;
+    }
+    wear_leveling.consolidation.checksum = fnv_64a_buf(&wear_leveling.cache[offset], length, wear_leveling.consolidation.checksum);
+    wear_leveling.consolidation.offset += length;
+
+    if (wear_leveling.consolidation.offset < (WEAR_LEVELING_LOGICAL_SIZE)) {
+        return WEAR_LEVELING_SUCCESS;
+    }
+
+    // Checksum covers what was actually written, later changes to earlier chunks are already in the new write log
+    wear_leveling.consolidation.state = CONSOLIDATION_IDLE;
+    return wear_leveling_write_checksum(wear_leveling.consolidation.checksum) ? WEAR_LEVELING_CONSOLIDATED : WEAR_LEVELING_FAILED;
+}
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
+#if defined(WEAR_LEVELING_DEFERRED_CONSOLIDATION) || defined(WEAR_LEVELING_WRITE_COALESCING)
+/**
+ * Performs background work: flushing coalesced writes once idle, and any deferred consolidation.
+ */
+wear_leveling_status_t wear_leveling_task(void) {
+    wear_leveling_status_t status = WEAR_LEVELING_SUCCESS;
+
+#    ifdef WEAR_LEVELING_WRITE_COALESCING
+    if (wear_leveling.pending_count > 0 && timer_elapsed32(wear_leveling.last_write) >= (WEAR_LEVELING_COALESCING_IDLE_MS)) {
+        status = wear_leveling_flush();
+        if (status != WEAR_LEVELING_SUCCESS) {
+            return status;
+        }
+    }
+#    endif // WEAR_LEVELING_WRITE_COALESCING
+
+#    ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+    if (wear_leveling.consolidation.state == CONSOLIDATION_IDLE) {
+        return status;
+    }
+
+    backing_store_lock_status_t lock_status = wear_leveling_unlock();
+    if (lock_status == STATUS_FAILURE) {
+        wear_leveling_lock();
+        return WEAR_LEVELING_FAILED;
+    }
+
+    status = wear_leveling_consolidate_step();
+
+    if (lock_status == STATUS_SUCCESS) {
+        if (wear_leveling_lock() == STATUS_FAILURE) {
+            status = WEAR_LEVELING_FAILED;
+        }
+    }
+#    endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
+    return status;
+}
+#endif // defined(WEAR_LEVELING_DEFERRED_CONSOLIDATION) || defined(WEAR_LEVELING_WRITE_COALESCING)
+
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+/**
+ * Whether a deferred consolidation is pending or in progress.
+ */
+bool wear_leveling_consolidation_pending(void) {
+    return wear_leveling.consolidation.state != CONSOLIDATION_IDLE;
+}
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
 /**
  * Reads logical data from the cache.
  */
@@ -743,6 +1041,22 @@ wear_leveling_status_t wear_leveling_read(const uint32_t address, void *value, s
     return WEAR_LEVELING_SUCCESS;
 }
 
+#ifdef WEAR_LEVELING_STATS
+/**
+ * Retrieves the write statistics.
+ */
+void wear_leveling_get_stats(wear_leveling_stats_t *stats) {
+    *stats = wear_leveling.stats;
+}
+
+/**
+ * Resets the write statistics.
+ */
+void wear_leveling_reset_stats(void) {
+    memset(&wear_leveling.stats, 0, sizeof(wear_leveling.stats));
+}
+#endif // WEAR_LEVELING_STATS
+
 /**
  * Weak implementation of bulk read, drivers can implement more optimised implementations.
  */
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
 
 /**
@@ -52,3 +53,59 @@ wear_leveling_status_t wear_leveling_write(uint32_t address, const void* value,
  * @return Status of the request
  */
 wear_leveling_status_t wear_leveling_read(uint32_t address, void* value, size_t length);
+
+#if defined(WEAR_LEVELING_DEFERRED_CONSOLIDATION) || defined(WEAR_LEVELING_WRITE_COALESCING)
+/**
+ * Performs background work: flushes coalesced writes once writes have been idle, and performs the next step of a
+ * deferred consolidation, if one is pending.
+ *
+ * Needs to be invoked periodically, outside of time-critical code paths.
+ *
+ * @return WEAR_LEVELING_CONSOLIDATED once the final step of a consolidation has been completed, WEAR_LEVELING_SUCCESS otherwise
+ */
+wear_leveling_status_t wear_leveling_task(void);
+#endif // defined(WEAR_LEVELING_DEFERRED_CONSOLIDATION) || defined(WEAR_LEVELING_WRITE_COALESCING)
+
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+/**
+ * Whether a deferred consolidation is pending or in progress.
+ */
+bool wear_leveling_consolidation_pending(void);
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+/**
+ * Writes any coalesced data to the write log.
+ *
+ * @return Status of the request
+ */
+wear_leveling_status_t wear_leveling_flush(void);
+
+/**
+ * Whether there is coalesced data yet to be written to the write log.
+ */
+bool wear_leveling_flush_pending(void);
+#endif // WEAR_LEVELING_WRITE_COALESCING
+
+#ifdef WEAR_LEVELING_STATS
+/**
+ * @typedef Counters of the write activity since the last reset.
+ */
+typedef struct wear_leveling_stats_t {
+    uint32_t logical_bytes;  //< Bytes of logical data changed
+    uint32_t log_entries;    //< Write log entries appended
+    uint32_t backing_writes; //< Write operations performed on the backing store for the write log
+} wear_leveling_stats_t;
+
+/**
+ * Retrieves the write statistics.
+ *
+ * @param stats[out] the current statistics
+ */
+void wear_leveling_get_stats(wear_leveling_stats_t* stats);
+
+/**
+ * Resets the write statistics.
+ */
+void wear_leveling_reset_stats(void);
+#endif // WEAR_LEVELING_STATS
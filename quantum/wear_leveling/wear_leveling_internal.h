@@ -61,10 +61,32 @@ typedef uint64_t backing_store_int_t;
         } while (0)
 #endif // WEAR_LEVELING_ASSERTS
 
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+#    ifndef WEAR_LEVELING_CONSOLIDATION_RESERVE
+#        define WEAR_LEVELING_CONSOLIDATION_RESERVE (((WEAR_LEVELING_BACKING_SIZE - WEAR_LEVELING_LOGICAL_SIZE - 8) / 4) & ~(BACKING_STORE_WRITE_SIZE - 1))
+#    endif
+#    ifndef WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE
+#        define WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE 64
+#    endif
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
+
+#ifdef WEAR_LEVELING_WRITE_COALESCING
+#    ifndef WEAR_LEVELING_COALESCING_RANGES
+#        define WEAR_LEVELING_COALESCING_RANGES 4
+#    endif
+#    ifndef WEAR_LEVELING_COALESCING_IDLE_MS
+#        define WEAR_LEVELING_COALESCING_IDLE_MS 1000
+#    endif
+#endif // WEAR_LEVELING_WRITE_COALESCING
+
 // Compile-time validation of configurable options
 _Static_assert(WEAR_LEVELING_BACKING_SIZE >= (WEAR_LEVELING_LOGICAL_SIZE * 2), "Total backing size must be at least twice the size of the logical size");
 _Static_assert(WEAR_LEVELING_LOGICAL_SIZE % BACKING_STORE_WRITE_SIZE == 0, "Logical size must be a multiple of write size");
 _Static_assert(WEAR_LEVELING_BACKING_SIZE % WEAR_LEVELING_LOGICAL_SIZE == 0, "Backing size must be a multiple of logical size");
+#ifdef WEAR_LEVELING_DEFERRED_CONSOLIDATION
+_Static_assert(WEAR_LEVELING_CONSOLIDATION_RESERVE < WEAR_LEVELING_BACKING_SIZE - WEAR_LEVELING_LOGICAL_SIZE - 8, "Consolidation reserve must be smaller than the write log");
+_Static_assert(WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE > 0 && WEAR_LEVELING_CONSOLIDATION_CHUNK_SIZE % BACKING_STORE_WRITE_SIZE == 0, "Consolidation chunk size must be a multiple of write size");
+#endif // WEAR_LEVELING_DEFERRED_CONSOLIDATION
 
 // Backing Store API, to be implemented elsewhere by flash driver etc.
 bool backing_store_init(void);
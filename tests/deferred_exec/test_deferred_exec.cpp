@@ -0,0 +1,112 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+
+extern "C" {
+#include "deferred_exec.h"
+#include "timer.h"
+
+void advance_time(uint32_t ms);
+}
+
+static std::vector<uintptr_t> calls;
+
+static uint32_t record_callback(uint32_t trigger_time, void *cb_arg) {
+    calls.push_back((uintptr_t)cb_arg);
+    return 0;
+}
+
+static uint32_t repeat_callback(uint32_t trigger_time, void *cb_arg) {
+    calls.push_back((uintptr_t)cb_arg);
+    return 10;
+}
+
+#define TABLE_SIZE 4
+
+class DeferredExec : public TestFixture {
+   protected:
+    void SetUp() override {
+        calls.clear();
+    }
+
+    deferred_token defer(uint32_t delay_ms, deferred_exec_callback callback, uintptr_t arg) {
+        return defer_exec_advanced(table, TABLE_SIZE, delay_ms, callback, (void *)arg);
+    }
+
+    bool extend(deferred_token token, uint32_t delay_ms) {
+        return extend_deferred_exec_advanced(table, TABLE_SIZE, token, delay_ms);
+    }
+
+    bool cancel(deferred_token token) {
+        return cancel_deferred_exec_advanced(table, TABLE_SIZE, token);
+    }
+
+    uint32_t time_until_next(void) {
+        return deferred_exec_advanced_time_until_next(table, TABLE_SIZE);
+    }
+
+    void run_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            deferred_exec_advanced_task(table, TABLE_SIZE, &last_execution);
+        }
+    }
+
+    deferred_executor_t table[TABLE_SIZE] = {};
+    uint32_t            last_execution    = 0;
+};
+
+TEST_F(DeferredExec, callbacks_run_in_deadline_order) {
+    defer(30, record_callback, 3);
+    defer(10, record_callback, 1);
+    defer(20, record_callback, 2);
+
+    EXPECT_EQ(time_until_next(), 10);
+    run_for(9);
+    EXPECT_TRUE(calls.empty());
+    EXPECT_EQ(time_until_next(), 1);
+
+    run_for(21);
+    EXPECT_EQ(calls, (std::vector<uintptr_t>{1, 2, 3}));
+    EXPECT_EQ(time_until_next(), DEFERRED_EXEC_NO_DEADLINE);
+}
+
+TEST_F(DeferredExec, cancel_and_extend_reorder_pending_callbacks) {
+    deferred_token first  = defer(10, record_callback, 1);
+    deferred_token second = defer(20, record_callback, 2);
+    defer(30, record_callback, 3);
+
+    EXPECT_TRUE(cancel(first));
+    EXPECT_FALSE(cancel(first));
+    EXPECT_EQ(time_until_next(), 20);
+
+    EXPECT_TRUE(extend(second, 40));
+    EXPECT_EQ(time_until_next(), 30);
+
+    run_for(40);
+    EXPECT_EQ(calls, (std::vector<uintptr_t>{3, 2}));
+}
+
+TEST_F(DeferredExec, repeating_callback_keeps_its_period) {
+    defer(10, repeat_callback, 1);
+    defer(15, record_callback, 2);
+
+    run_for(30);
+    EXPECT_EQ(calls, (std::vector<uintptr_t>{1, 2, 1, 1}));
+    EXPECT_EQ(time_until_next(), 10);
+}
+
+TEST_F(DeferredExec, full_table_rejects_new_callbacks) {
+    for (uintptr_t i = 0; i < TABLE_SIZE; i++) {
+        EXPECT_NE(defer(10 + i, record_callback, i), INVALID_DEFERRED_TOKEN);
+    }
+    EXPECT_EQ(defer(5, record_callback, 0), INVALID_DEFERRED_TOKEN);
+
+    run_for(10);
+    EXPECT_EQ(calls, (std::vector<uintptr_t>{0}));
+    EXPECT_NE(defer(5, record_callback, 9), INVALID_DEFERRED_TOKEN);
+}
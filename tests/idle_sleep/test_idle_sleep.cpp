@@ -0,0 +1,88 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "deferred_exec.h"
+#include "idle_sleep.h"
+#include "timer.h"
+}
+
+
+static uint32_t noop_callback(uint32_t trigger_time, void *cb_arg) {
+    return 0;
+}
+
+class IdleSleep : public TestFixture {};
+
+TEST_F(IdleSleep, no_sleep_until_input_has_been_quiet) {
+    TestDriver driver;
+    auto       key = KeymapKey(0, 0, 0, KC_A);
+    set_keymap({key});
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key);
+    VERIFY_AND_CLEAR(driver);
+    EXPECT_EQ(idle_sleep_duration(), 0);
+
+    idle_for(IDLE_SLEEP_TIMEOUT);
+    EXPECT_EQ(idle_sleep_duration(), IDLE_SLEEP_MAX_MS);
+}
+
+TEST_F(IdleSleep, held_key_keeps_the_loop_awake) {
+    TestDriver driver;
+    auto       key = KeymapKey(0, 0, 0, KC_A);
+    set_keymap({key});
+
+    EXPECT_REPORT(driver, (KC_A));
+    key.press();
+    run_one_scan_loop();
+    idle_for(IDLE_SLEEP_TIMEOUT * 2);
+    EXPECT_EQ(idle_sleep_duration(), 0);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(IdleSleep, earliest_deadline_wins_and_is_cleared_by_the_sleep) {
+    TestDriver driver;
+    idle_for(IDLE_SLEEP_TIMEOUT);
+
+    idle_sleep_request(7);
+    idle_sleep_request(3);
+    EXPECT_EQ(idle_sleep_duration(), 3);
+
+    uint32_t before = timer_read32();
+    idle_sleep_task();
+    EXPECT_EQ(timer_elapsed32(before), 3);
+    EXPECT_EQ(idle_sleep_duration(), IDLE_SLEEP_MAX_MS);
+}
+
+TEST_F(IdleSleep, deferred_executors_cut_the_sleep_short) {
+    TestDriver driver;
+    idle_for(IDLE_SLEEP_TIMEOUT);
+
+    deferred_token token = defer_exec(4, noop_callback, NULL);
+    EXPECT_EQ(idle_sleep_duration(), 4);
+    cancel_deferred_exec(token);
+    EXPECT_EQ(idle_sleep_duration(), IDLE_SLEEP_MAX_MS);
+}
+
+TEST_F(IdleSleep, activity_keeps_the_loop_awake) {
+    TestDriver driver;
+    idle_for(IDLE_SLEEP_TIMEOUT);
+
+    idle_sleep_activity();
+    EXPECT_EQ(idle_sleep_duration(), 0);
+    idle_for(IDLE_SLEEP_TIMEOUT);
+    EXPECT_EQ(idle_sleep_duration(), IDLE_SLEEP_MAX_MS);
+}
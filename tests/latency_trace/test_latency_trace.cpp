@@ -0,0 +1,146 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "latency_trace.h"
+}
+
+using testing::_;
+using testing::InSequence;
+
+class LatencyTrace : public TestFixture {
+   protected:
+    void SetUp() override {
+        latency_trace_clear();
+    }
+
+    latency_trace_entry_t latest(uint8_t age = 0) {
+        latency_trace_entry_t entry = {};
+        EXPECT_TRUE(latency_trace_get(age, &entry));
+        return entry;
+    }
+};
+
+TEST_F(LatencyTrace, regular_key_is_reported_in_the_same_scan) {
+    TestDriver driver;
+    InSequence s;
+    auto       regular_key = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({regular_key});
+
+    EXPECT_REPORT(driver, (KC_A));
+    regular_key.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    ASSERT_EQ(latency_trace_count(), 1);
+    EXPECT_EQ(latest().latency_us, 0);
+    EXPECT_EQ(latest().key.col, 1);
+    EXPECT_EQ(latest().key.row, 0);
+    EXPECT_TRUE(latest().pressed);
+
+    EXPECT_EMPTY_REPORT(driver);
+    regular_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    ASSERT_EQ(latency_trace_count(), 2);
+    EXPECT_FALSE(latest().pressed);
+}
+
+TEST_F(LatencyTrace, key_without_report_is_not_traced) {
+    TestDriver driver;
+    InSequence s;
+    auto       layer_key = KeymapKey(0, 1, 0, MO(1));
+
+    set_keymap({layer_key});
+
+    EXPECT_NO_REPORT(driver);
+    layer_key.press();
+    run_one_scan_loop();
+    layer_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EQ(latency_trace_count(), 0);
+}
+
+TEST_F(LatencyTrace, tapped_mod_tap_key_waits_for_its_release) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+
+    set_keymap({mod_tap_key});
+
+    EXPECT_NO_REPORT(driver);
+    mod_tap_key.press();
+    idle_for(20);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_P));
+    EXPECT_EMPTY_REPORT(driver);
+    mod_tap_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    /* The press is only known to be a tap once the key is released. */
+    ASSERT_GE(latency_trace_count(), 1);
+    latency_trace_entry_t press = latest(latency_trace_count() - 1);
+    EXPECT_TRUE(press.pressed);
+    EXPECT_EQ(press.latency_us, 20 * 1000);
+    EXPECT_LT(press.latency_us, TAPPING_TERM * 1000);
+}
+
+TEST_F(LatencyTrace, held_mod_tap_key_waits_for_tapping_term) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+
+    set_keymap({mod_tap_key});
+
+    EXPECT_REPORT(driver, (KC_LSFT));
+    mod_tap_key.press();
+    idle_for(TAPPING_TERM + 1);
+    VERIFY_AND_CLEAR(driver);
+
+    ASSERT_EQ(latency_trace_count(), 1);
+    EXPECT_GE(latest().latency_us, TAPPING_TERM * 1000);
+    EXPECT_LE(latest().latency_us, (TAPPING_TERM + 1) * 1000);
+
+    EXPECT_EMPTY_REPORT(driver);
+    mod_tap_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    /* The release is not buffered once the key is held. */
+    EXPECT_EQ(latest().latency_us, 0);
+}
+
+TEST_F(LatencyTrace, ring_buffer_keeps_most_recent_entries) {
+    TestDriver driver;
+    auto       regular_key = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({regular_key});
+
+    EXPECT_ANY_REPORT(driver).Times(2 * (LATENCY_TRACE_BUFFER_SIZE + 1));
+    for (int i = 0; i < LATENCY_TRACE_BUFFER_SIZE + 1; i++) {
+        regular_key.press();
+        run_one_scan_loop();
+        regular_key.release();
+        run_one_scan_loop();
+    }
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EQ(latency_trace_count(), LATENCY_TRACE_BUFFER_SIZE);
+    EXPECT_FALSE(latest(0).pressed);
+    EXPECT_TRUE(latest(1).pressed);
+
+    latency_trace_entry_t entry;
+    EXPECT_FALSE(latency_trace_get(LATENCY_TRACE_BUFFER_SIZE, &entry));
+}
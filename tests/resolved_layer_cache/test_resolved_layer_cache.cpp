@@ -0,0 +1,110 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class ResolvedLayerCache : public TestFixture {};
+
+TEST_F(ResolvedLayerCache, ResolvesTopmostNonTransparentLayer) {
+    TestDriver driver;
+    KeymapKey  key_a    = KeymapKey{0, 0, 0, KC_A};
+    KeymapKey  key_b    = KeymapKey{1, 0, 0, KC_TRNS};
+    KeymapKey  key_c    = KeymapKey{2, 0, 0, KC_C};
+    keypos_t   position = key_a.position;
+
+    set_keymap({key_a, key_b, key_c});
+
+    EXPECT_EQ(layer_switch_get_layer(position), 0);
+
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(position), 0);
+
+    layer_on(2);
+    EXPECT_EQ(layer_switch_get_layer(position), 2);
+    EXPECT_EQ(layer_switch_get_layer(position), 2);
+
+    layer_off(2);
+    EXPECT_EQ(layer_switch_get_layer(position), 0);
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ResolvedLayerCache, PicksUpDirectLayerStateWrites) {
+    TestDriver driver;
+    KeymapKey  key_a    = KeymapKey{0, 0, 0, KC_A};
+    KeymapKey  key_b    = KeymapKey{1, 0, 0, KC_B};
+    keypos_t   position = key_a.position;
+
+    set_keymap({key_a, key_b});
+
+    EXPECT_EQ(layer_switch_get_layer(position), 0);
+
+    /* e.g. split slaves assign the synced state without going through layer_state_set() */
+    layer_state = (layer_state_t)1 << 1;
+    EXPECT_EQ(layer_switch_get_layer(position), 1);
+
+    layer_state         = 0;
+    default_layer_state = (layer_state_t)1 << 1;
+    EXPECT_EQ(layer_switch_get_layer(position), 1);
+
+    default_layer_state = (layer_state_t)1 << 0;
+    EXPECT_EQ(layer_switch_get_layer(position), 0);
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ResolvedLayerCache, KeymapChangeInvalidatesCache) {
+    TestDriver driver;
+    KeymapKey  key_a    = KeymapKey{0, 0, 0, KC_A};
+    keypos_t   position = key_a.position;
+
+    set_keymap({key_a, KeymapKey{1, 0, 0, KC_TRNS}});
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(position), 0);
+
+    set_keymap({key_a, KeymapKey{1, 0, 0, KC_B}});
+    EXPECT_EQ(layer_switch_get_layer(position), 1);
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ResolvedLayerCache, MomentaryLayerKeypress) {
+    TestDriver driver;
+    InSequence s;
+    KeymapKey  layer_key = KeymapKey{0, 0, 0, MO(1)};
+    KeymapKey  key_a     = KeymapKey{0, 1, 0, KC_A};
+    KeymapKey  key_b     = KeymapKey{1, 1, 0, KC_B};
+
+    set_keymap({layer_key, key_a, key_b, KeymapKey{1, 0, 0, KC_TRNS}});
+
+    /* Tap A on the base layer to fill the cache */
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+
+    /* Hold MO(1), the same position must now resolve to layer 1 */
+    EXPECT_NO_REPORT(driver);
+    layer_key.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_B));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_b);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_NO_REPORT(driver);
+    layer_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -99,6 +99,10 @@ void TestFixture::add_key(KeymapKey key) {
     }
 
     this->keymap.push_back(key);
+
+#ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#endif
 }
 
 void TestFixture::tap_key(KeymapKey key, unsigned delay_ms) {
@@ -126,6 +130,9 @@ void TestFixture::tap_combo(const std::vector<KeymapKey>& chord_keys, unsigned d
 
 void TestFixture::set_keymap(std::initializer_list<KeymapKey> keys) {
     this->keymap.clear();
+#ifdef RESOLVED_LAYER_CACHE
+    clear_resolved_layer_cache();
+#endif
     for (auto& key : keys) {
         add_key(key);
     }
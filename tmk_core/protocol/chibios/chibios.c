@@ -33,6 +33,7 @@
 #include "sendchar.h"
 #include "debug.h"
 #include "print.h"
+#include "profiling.h"
 
 #ifndef EARLY_INIT_PERFORM_BOOTLOADER_JUMP
 // Change this to be TRUE once we've migrated keyboards to the new init system
@@ -216,6 +217,6 @@ void protocol_post_task(void) {
     virtser_task();
 #endif
 #ifdef RAW_ENABLE
-    raw_hid_task();
+    PROFILE_TASK(PROFILE_RAW_HID, raw_hid_task());
 #endif
 }
@@ -35,6 +35,9 @@
 #include "chibios_config.h"
 #include "debug.h"
 #include "suspend.h"
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
 #ifdef SLEEP_LED_ENABLE
 #    include "sleep_led.h"
 #    include "led.h"
@@ -984,6 +987,10 @@ void raw_hid_task(void) {
     do {
         size = chnReadTimeout(&drivers.raw_driver.driver, buffer, sizeof(buffer), TIME_IMMEDIATE);
         if (size > 0) {
+#    ifdef IDLE_SLEEP_ENABLE
+            // host tools send bursts of requests, don't sleep between them
+            idle_sleep_activity();
+#    endif
             raw_hid_receive(buffer, size);
         }
     } while (size > 0);
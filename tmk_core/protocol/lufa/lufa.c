@@ -44,10 +44,14 @@
 #include "led.h"
 #include "sendchar.h"
 #include "debug.h"
+#include "profiling.h"
 #ifdef SLEEP_LED_ENABLE
 #    include "sleep_led.h"
 #endif
 #include "suspend.h"
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
 #include "wait.h"
 
 #include "usb_descriptor.h"
@@ -174,6 +178,10 @@ static void raw_hid_task(void) {
         Endpoint_ClearOUT();
 
         if (data_read) {
+#    ifdef IDLE_SLEEP_ENABLE
+            // host tools send bursts of requests, don't sleep between them
+            idle_sleep_activity();
+#    endif
             raw_hid_receive(data, sizeof(data));
         }
     }
@@ -886,7 +894,7 @@ void protocol_post_task(void) {
 #endif
 
 #ifdef RAW_ENABLE
-    raw_hid_task();
+    PROFILE_TASK(PROFILE_RAW_HID, raw_hid_task());
 #endif
 
 #if !defined(INTERRUPT_CONTROL_ENDPOINT)
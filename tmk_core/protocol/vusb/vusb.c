@@ -29,6 +29,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 #include "wait.h"
+#ifdef IDLE_SLEEP_ENABLE
+#    include "idle_sleep.h"
+#endif
 #include "usb_descriptor_common.h"
 
 #ifdef RAW_ENABLE
@@ -163,6 +166,10 @@ __attribute__((weak)) void raw_hid_receive(uint8_t *data, uint8_t length) {
 
 void raw_hid_task(void) {
     if (raw_output_received_bytes == RAW_BUFFER_SIZE) {
+#    ifdef IDLE_SLEEP_ENABLE
+        // host tools send bursts of requests, don't sleep between them
+        idle_sleep_activity();
+#    endif
         raw_hid_receive(raw_output_buffer, RAW_BUFFER_SIZE);
         raw_output_received_bytes = 0;
     }
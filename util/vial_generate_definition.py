@@ -2,6 +2,7 @@
 import sys
 import json
 import lzma
+import zlib
 
 def main():
     if len(sys.argv) != 3:
@@ -23,6 +24,7 @@ def main():
         arr = ["0x{:02X}".format(b) for b in data]
         outf.write(", ".join(arr))
         outf.write("};\n")
+        outf.write("#define VIAL_KEYBOARD_DEFINITION_CRC32 0x{:08X}UL\n".format(zlib.crc32(data) & 0xFFFFFFFF))
 
     return 0
 